@@ -0,0 +1,543 @@
+/**
+ * @file bench_caesar.cpp
+ * @brief Набор микробенчмарков: шифр, парсер, сериализатор, логгер
+ *
+ * Корпуса синтетические и детерминированные (mt19937 с фиксированным
+ * зерном): английский, русский и смешанный текст, записи по 64 Б, 1 КиБ
+ * и 64 КиБ. Каждый замер — прогрев и серия повторений; в отчёт идут
+ * медиана, p99, минимум и среднее, МБ/с и нс на элемент.
+ *
+ * Результаты печатаются таблицей, с --json сохраняются в JSON для
+ * сравнения между версиями, с --compare сравниваются с прошлым JSON:
+ * код возврата 1, если медиана какого-либо замера выросла больше порога.
+ */
+
+#include "cipher.h"
+#include "json_parser.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// === Параметры запуска ===
+
+struct BenchOptions {
+    int repetitions = 20;
+    int warmup = 3;
+    size_t corpusBytes = 4u << 20;  // Объём данных на один прогон
+    string filter;                  // Подстрока имени замера
+    string jsonFile;
+    string compareFile;
+    double threshold = 10.0;        // Допустимый рост медианы, %
+};
+
+/**
+ * @brief Результат одного замера
+ */
+struct BenchResult {
+    string name;
+    size_t bytes = 0;       // Байтов входа на прогон (0 — не применимо)
+    size_t items = 0;       // Элементов на прогон (записей, вызовов)
+    double medianNs = 0;
+    double p99Ns = 0;
+    double minNs = 0;
+    double meanNs = 0;
+
+    double megabytesPerSecond() const {
+        return bytes > 0 ? bytes / (medianNs / 1e9) / 1e6 : 0;
+    }
+
+    double nsPerItem() const {
+        return items > 0 ? medianNs / items : 0;
+    }
+};
+
+// Не даёт компилятору выбросить результат измеряемого кода
+volatile size_t benchSink = 0;
+
+// === Корпуса ===
+
+const vector<string> ENGLISH_WORDS = {
+    "the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "cipher",
+    "secret", "message", "Caesar", "Rome", "legion", "shift", "letter", "key",
+    "alphabet", "encrypt", "decrypt", "history", "simple", "substitution"
+};
+
+const vector<string> RUSSIAN_WORDS = {
+    "быстрая", "коричневая", "лиса", "прыгает", "через", "ленивую", "собаку",
+    "шифр", "секрет", "сообщение", "Цезарь", "Рим", "легион", "сдвиг", "буква",
+    "ключ", "алфавит", "ёж", "история", "простой", "замена", "Москва"
+};
+
+/**
+ * @brief Текст из слов словаря длиной не меньше length байт
+ *
+ * lang: 'E' — английский, 'R' — русский, 'M' — слова вперемешку.
+ */
+string makeText(char lang, size_t length, mt19937& rng) {
+    string text;
+    text.reserve(length + 32);
+    while (text.size() < length) {
+        bool russian = lang == 'R' || (lang == 'M' && rng() % 2 == 0);
+        const vector<string>& words = russian ? RUSSIAN_WORDS : ENGLISH_WORDS;
+        text += words[rng() % words.size()];
+        unsigned punctuation = rng() % 12;
+        text += punctuation == 0 ? ". " : punctuation == 1 ? ", " : " ";
+    }
+    return text;
+}
+
+/**
+ * @brief Набор записей по recordBytes байт общим объёмом ~totalBytes
+ */
+vector<string> makeRecords(char lang, size_t recordBytes, size_t totalBytes, unsigned seed) {
+    mt19937 rng(seed);
+    size_t count = max<size_t>(1, totalBytes / recordBytes);
+    vector<string> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        records.push_back(makeText(lang, recordBytes, rng));
+    }
+    return records;
+}
+
+/**
+ * @brief JSON-массив записей входного формата программы
+ *
+ * escapes: точки заменяются переводами строк, запятые — кавычками,
+ * и в строках JSON появляются escape-последовательности.
+ */
+string makeJsonCorpus(size_t recordBytes, size_t totalBytes, unsigned seed, bool escapes = false) {
+    vector<string> contents = makeRecords('M', recordBytes, totalBytes, seed);
+    if (escapes) {
+        for (auto& content : contents) {
+            replace(content.begin(), content.end(), '.', '\n');
+            replace(content.begin(), content.end(), ',', '"');
+        }
+    }
+    string json = "[\n";
+    for (size_t i = 0; i < contents.size(); i++) {
+        json += "  {\"id\": " + to_string(i + 1) + ", \"content\": ";
+        appendJsonString(json, contents[i]);
+        json += ", \"lang\": \"" + string(i % 2 ? "E" : "R") + "\", \"key_used\": 7}";
+        json += (i + 1 < contents.size()) ? ",\n" : "\n";
+    }
+    json += "]\n";
+    return json;
+}
+
+size_t totalSize(const vector<string>& records) {
+    size_t total = 0;
+    for (const auto& record : records) total += record.size();
+    return total;
+}
+
+string sizeLabel(size_t bytes) {
+    return bytes >= 1024 ? to_string(bytes / 1024) + "k" : to_string(bytes);
+}
+
+// === Измерение ===
+
+/**
+ * @brief Прогрев, затем options.repetitions прогонов body()
+ */
+template <typename Body>
+BenchResult measure(const string& name, size_t bytes, size_t items,
+                    const BenchOptions& options, Body&& body) {
+    for (int i = 0; i < options.warmup; i++) {
+        body();
+    }
+
+    vector<double> samples;
+    samples.reserve(options.repetitions);
+    for (int i = 0; i < options.repetitions; i++) {
+        auto start = chrono::steady_clock::now();
+        body();
+        auto finish = chrono::steady_clock::now();
+        samples.push_back(chrono::duration<double, nano>(finish - start).count());
+    }
+    sort(samples.begin(), samples.end());
+
+    size_t count = samples.size();
+    size_t p99Index = min(count - 1, static_cast<size_t>(ceil(count * 0.99)) - 1);
+
+    BenchResult result;
+    result.name = name;
+    result.bytes = bytes;
+    result.items = items;
+    result.medianNs = count % 2 ? samples[count / 2]
+                                : (samples[count / 2 - 1] + samples[count / 2]) / 2;
+    result.p99Ns = samples[p99Index];
+    result.minNs = samples.front();
+    result.meanNs = accumulate(samples.begin(), samples.end(), 0.0) / count;
+    return result;
+}
+
+/**
+ * @brief Дополняет UTF-8 строку пробелами слева до width символов
+ *
+ * setw считает байты, а кириллический символ занимает два.
+ */
+string padLeft(const string& text, size_t width) {
+    size_t characters = count_if(text.begin(), text.end(), [](char c) {
+        return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    });
+    return string(width > characters ? width - characters : 0, ' ') + text;
+}
+
+void printHeader() {
+    cout << "Замер" << string(29, ' ')
+         << padLeft("медиана, мс", 12) << padLeft("p99, мс", 12)
+         << padLeft("МБ/с", 10) << padLeft("нс/элемент", 14) << "\n";
+    cout << string(82, '-') << "\n";
+}
+
+void printResult(const BenchResult& result) {
+    cout << left << setw(34) << result.name << right << fixed
+         << setprecision(3) << setw(12) << result.medianNs / 1e6
+         << setw(12) << result.p99Ns / 1e6
+         << setprecision(1) << setw(10);
+    if (result.bytes > 0) cout << result.megabytesPerSecond(); else cout << "-";
+    cout << setw(14) << result.nsPerItem() << "\n";
+}
+
+// === Наборы замеров ===
+
+class BenchSuite {
+private:
+    const BenchOptions& options;
+    vector<BenchResult> results;
+
+    bool selected(const string& name) const {
+        return options.filter.empty() || name.find(options.filter) != string::npos;
+    }
+
+public:
+    explicit BenchSuite(const BenchOptions& opts) : options(opts) {}
+
+    template <typename Body>
+    void add(const string& name, size_t bytes, size_t items, Body&& body) {
+        if (!selected(name)) return;
+        results.push_back(measure(name, bytes, items, options, body));
+        printResult(results.back());
+    }
+
+    const vector<BenchResult>& getResults() const {
+        return results;
+    }
+};
+
+void benchCipher(BenchSuite& suite, const BenchOptions& options) {
+    const struct { char corpus; char lang; const char* label; } languages[] = {
+        {'E', 'E', "en"}, {'R', 'R', "ru"}, {'M', 'E', "mixed"}
+    };
+    const size_t recordSizes[] = {64, 1024, 65536};
+
+    unsigned seed = 1;
+    for (const auto& language : languages) {
+        for (size_t recordBytes : recordSizes) {
+            vector<string> records = makeRecords(language.corpus, recordBytes, options.corpusBytes, seed++);
+            vector<string> encrypted;
+            encrypted.reserve(records.size());
+            for (const auto& record : records) {
+                encrypted.push_back(encryptCaesar(record, 7, language.lang));
+            }
+            size_t bytes = totalSize(records);
+            string suffix = string(language.label) + "/" + sizeLabel(recordBytes);
+            char lang = language.lang;
+
+            suite.add("encrypt/" + suffix, bytes, records.size(), [&]() {
+                size_t sum = 0;
+                for (const auto& record : records) sum += encryptCaesar(record, 7, lang).size();
+                benchSink = benchSink + sum;
+            });
+            suite.add("decrypt/" + suffix, bytes, encrypted.size(), [&]() {
+                size_t sum = 0;
+                for (const auto& record : encrypted) sum += decryptCaesar(record, 7, lang).size();
+                benchSink = benchSink + sum;
+            });
+        }
+    }
+}
+
+void benchCrack(BenchSuite& suite, const BenchOptions& options) {
+    const struct { char lang; const char* label; } languages[] = {{'E', "en"}, {'R', "ru"}};
+    const size_t recordSizes[] = {1024, 65536};
+
+    unsigned seed = 50;
+    for (const auto& language : languages) {
+        for (size_t recordBytes : recordSizes) {
+            vector<string> encrypted = makeRecords(language.lang, recordBytes, options.corpusBytes, seed++);
+            for (auto& record : encrypted) {
+                encryptCaesarInPlace(record, 7, language.lang);
+            }
+            size_t bytes = totalSize(encrypted);
+            string suffix = string(language.label) + "/" + sizeLabel(recordBytes);
+            char lang = language.lang;
+
+            suite.add("crack/" + suffix, bytes, encrypted.size(), [&]() {
+                size_t sum = 0;
+                for (const auto& record : encrypted) sum += crackCaesar(record, lang).text.size();
+                benchSink = benchSink + sum;
+            });
+            // Прежний способ: расшифровка каждым ключом и оценка результата
+            suite.add("crack/brute/" + suffix, bytes, encrypted.size(), [&]() {
+                size_t sum = 0;
+                int size = getAlphabetSize(lang);
+                for (const auto& record : encrypted) {
+                    string best = record;
+                    double bestScore = scoreCaesarKeys(buildLetterHistogram(record), lang)[0];
+                    for (int key = 1; key < size; key++) {
+                        string candidate = decryptCaesar(record, key, lang);
+                        double score = scoreCaesarKeys(buildLetterHistogram(candidate), lang)[0];
+                        if (score < bestScore) {
+                            bestScore = score;
+                            best = move(candidate);
+                        }
+                    }
+                    sum += best.size();
+                }
+                benchSink = benchSink + sum;
+            });
+        }
+    }
+}
+
+void benchJson(BenchSuite& suite, const BenchOptions& options) {
+    const size_t recordSizes[] = {64, 1024, 65536};
+
+    unsigned seed = 100;
+    for (size_t recordBytes : recordSizes) {
+        string corpus = makeJsonCorpus(recordBytes, options.corpusBytes, seed++);
+        JsonValue tree = parseJson(corpus);
+        size_t records = tree.asArray().size();
+        string label = sizeLabel(recordBytes);
+
+        suite.add("parseJson/" + label, corpus.size(), records, [&]() {
+            JsonValue parsed = parseJson(corpus);
+            benchSink = benchSink + parsed.asArray().size();
+        });
+        suite.add("parseJson/arena/" + label, corpus.size(), records, [&]() {
+            JsonArenaDocument document(corpus);
+            benchSink = benchSink + document.root().asArray().size();
+        });
+
+        size_t compactBytes = jsonToString(tree, false).size();
+        size_t prettyBytes = jsonToString(tree, true).size();
+        suite.add("jsonToString/compact/" + label, compactBytes, records, [&]() {
+            benchSink = benchSink + jsonToString(tree, false).size();
+        });
+        suite.add("jsonToString/pretty/" + label, prettyBytes, records, [&]() {
+            benchSink = benchSink + jsonToString(tree, true).size();
+        });
+    }
+
+    // Участки без экранирования чередуются с escape-последовательностями
+    string escaped = makeJsonCorpus(1024, options.corpusBytes, seed++, true);
+    size_t escapedRecords = parseJson(escaped).asArray().size();
+    suite.add("parseJson/escaped/1k", escaped.size(), escapedRecords, [&]() {
+        JsonValue parsed = parseJson(escaped);
+        benchSink = benchSink + parsed.asArray().size();
+    });
+    suite.add("parseJson/arena/escaped/1k", escaped.size(), escapedRecords, [&]() {
+        JsonArenaDocument document(escaped);
+        benchSink = benchSink + document.root().asArray().size();
+    });
+}
+
+void benchLogger(BenchSuite& suite) {
+    const size_t calls = 10000;
+    string logFile = (filesystem::temp_directory_path() / "bench_caesar_operations.log").string();
+    auto removeLog = [&]() {
+        error_code error;
+        filesystem::remove(logFile, error);
+    };
+
+    removeLog();
+    {
+        Logger logger(logFile);
+        suite.add("Logger::log/sync", 0, calls, [&]() {
+            for (size_t i = 0; i < calls; i++) {
+                logger.log(i % 2 ? "encrypt" : "decrypt", 7, static_cast<int>(i), "успешно");
+            }
+            logger.saveToFile();
+        });
+    }
+    removeLog();
+    {
+        Logger logger(logFile);
+        logger.startAsync();
+        suite.add("Logger::log/async", 0, calls, [&]() {
+            for (size_t i = 0; i < calls; i++) {
+                logger.log(i % 2 ? "encrypt" : "decrypt", 7, static_cast<int>(i), "успешно");
+            }
+            logger.saveToFile();
+        });
+    }
+    removeLog();
+}
+
+// === Отчёт в JSON ===
+
+/**
+ * @brief Записывает результаты в JSON
+ *
+ * Числа пишутся с фиксированной точкой: сериализатор JsonValue оставляет
+ * шесть значащих цифр и для больших значений переходит к экспоненте.
+ */
+bool writeJsonReport(const string& filename, const BenchOptions& options,
+                     const vector<BenchResult>& results) {
+    auto number = [](double value, int precision) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+        return string(buffer);
+    };
+
+    string json = "{\n  \"benchmark\": \"bench_caesar\",\n  \"timestamp\": ";
+    appendJsonString(json, getCurrentTimestamp());
+    json += ",\n  \"compiler\": ";
+    appendJsonString(json, __VERSION__);
+    json += ",\n  \"cipher_kernel\": ";
+    appendJsonString(json, getCipherKernelName(getCipherKernel()));
+    json += ",\n  \"repetitions\": " + to_string(options.repetitions);
+    json += ",\n  \"warmup\": " + to_string(options.warmup);
+    json += ",\n  \"corpus_bytes\": " + to_string(options.corpusBytes);
+    json += ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        json += i == 0 ? "\n    {\"name\": " : ",\n    {\"name\": ";
+        appendJsonString(json, result.name);
+        json += ", \"bytes\": " + to_string(result.bytes);
+        json += ", \"items\": " + to_string(result.items);
+        json += ", \"median_ns\": " + number(result.medianNs, 1);
+        json += ", \"p99_ns\": " + number(result.p99Ns, 1);
+        json += ", \"min_ns\": " + number(result.minNs, 1);
+        json += ", \"mean_ns\": " + number(result.meanNs, 1);
+        json += ", \"mb_per_s\": " + (result.bytes > 0 ? number(result.megabytesPerSecond(), 2) : "null");
+        json += ", \"ns_per_item\": " + number(result.nsPerItem(), 2) + "}";
+    }
+    json += results.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+    ofstream out(filename, ios::binary);
+    out << json;
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Сравнивает медианы с прошлым отчётом
+ *
+ * @return Число замеров, медиана которых выросла больше порога
+ */
+int compareWithBaseline(const string& filename, const BenchOptions& options,
+                        const vector<BenchResult>& results) {
+    map<string, double> baseline;
+    JsonValue report = loadJsonFile(filename);
+    for (const auto& item : report.asObject().at("results").asArray()) {
+        const JsonObject& obj = item.asObject();
+        baseline[obj.at("name").asString()] = obj.at("median_ns").asNumber();
+    }
+
+    cout << "\nСравнение с " << filename << " (порог " << options.threshold << "%):\n";
+    int regressions = 0;
+    for (const auto& result : results) {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end() || it->second <= 0) continue;
+        double change = (result.medianNs / it->second - 1) * 100;
+        bool regression = change > options.threshold;
+        regressions += regression;
+        cout << "  " << left << setw(34) << result.name << right << showpos << fixed
+             << setprecision(1) << setw(8) << change << "%" << noshowpos
+             << (regression ? "  ✗ регрессия" : "") << "\n";
+    }
+    return regressions;
+}
+
+// === Точка входа ===
+
+void printUsage() {
+    cout << "Использование: bench_caesar [ОПЦИИ]\n\n"
+         << "  --repetitions N   Прогонов на замер (по умолчанию 20)\n"
+         << "  --warmup N        Прогревочных прогонов (по умолчанию 3)\n"
+         << "  --size-mb N       Объём корпуса на прогон, МБ (по умолчанию 4)\n"
+         << "  --filter TEXT     Только замеры, в имени которых есть TEXT\n"
+         << "  --json FILE       Сохранить результаты в JSON\n"
+         << "  --compare FILE    Сравнить с прошлым JSON, код 1 при регрессии\n"
+         << "  --threshold PCT   Порог регрессии медианы, % (по умолчанию 10)\n";
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--help") {
+                printUsage();
+                return 0;
+            } else if (arg == "--repetitions" && i + 1 < argc) {
+                options.repetitions = max(1, stoi(argv[++i]));
+            } else if (arg == "--warmup" && i + 1 < argc) {
+                options.warmup = max(0, stoi(argv[++i]));
+            } else if (arg == "--size-mb" && i + 1 < argc) {
+                options.corpusBytes = static_cast<size_t>(max(1.0 / 1024, stod(argv[++i])) * (1u << 20));
+            } else if (arg == "--filter" && i + 1 < argc) {
+                options.filter = argv[++i];
+            } else if (arg == "--json" && i + 1 < argc) {
+                options.jsonFile = argv[++i];
+            } else if (arg == "--compare" && i + 1 < argc) {
+                options.compareFile = argv[++i];
+            } else if (arg == "--threshold" && i + 1 < argc) {
+                options.threshold = stod(argv[++i]);
+            } else {
+                cerr << "Неизвестный параметр: " << arg << "\n";
+                printUsage();
+                return 2;
+            }
+        }
+    } catch (const exception&) {
+        cerr << "Некорректное значение параметра\n";
+        return 2;
+    }
+
+    cout << "Ядро шифра: " << getCipherKernelName(getCipherKernel())
+         << ", корпус " << options.corpusBytes / 1024 << " КиБ на прогон, "
+         << options.warmup << " прогрева + " << options.repetitions << " прогонов\n\n";
+    printHeader();
+
+    BenchSuite suite(options);
+    benchCipher(suite, options);
+    benchCrack(suite, options);
+    benchJson(suite, options);
+    benchLogger(suite);
+
+    if (!options.jsonFile.empty()) {
+        if (!writeJsonReport(options.jsonFile, options, suite.getResults())) {
+            cerr << "Не удалось записать " << options.jsonFile << "\n";
+            return 2;
+        }
+        cout << "\nРезультаты сохранены в " << options.jsonFile << "\n";
+    }
+
+    if (!options.compareFile.empty()) {
+        try {
+            if (compareWithBaseline(options.compareFile, options, suite.getResults()) > 0) {
+                return 1;
+            }
+        } catch (const exception& e) {
+            cerr << "Не удалось прочитать " << options.compareFile << ": " << e.what() << "\n";
+            return 2;
+        }
+    }
+    return 0;
+}
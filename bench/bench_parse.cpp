@@ -0,0 +1,93 @@
+/**
+ * @file bench_parse.cpp
+ * @brief Бенчмарк разбора и освобождения дерева JSON
+ *
+ * Сравнивает обычный режим (parseJson, узлы в куче) и режим арены
+ * (JsonArenaDocument) на синтетическом массиве записей вида
+ * {"id": N, "content": "..."}. Измеряется суммарное время разбора
+ * и уничтожения дерева.
+ */
+
+#include "json_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+string makeCorpus(size_t records) {
+    const string english = "The quick brown fox jumps over the lazy dog. ";
+    const string russian = "Быстрая коричневая лиса прыгает через ленивую собаку. ";
+    
+    string json = "[\n";
+    for (size_t i = 0; i < records; i++) {
+        json += "  {\"id\": " + to_string(i + 1) + ", \"content\": \"";
+        json += (i % 2 == 0) ? english + english : russian + russian;
+        json += "\", \"operation\": \"encrypt\", \"key_used\": 7}";
+        json += (i + 1 < records) ? ",\n" : "\n";
+    }
+    json += "]\n";
+    return json;
+}
+
+struct Timing {
+    double parseMs;
+    double destroyMs;
+};
+
+/**
+ * @brief Медианы времени разбора и освобождения дерева
+ *
+ * make() разбирает корпус и возвращает владеющий указатель; его сброс
+ * измеряется отдельно.
+ */
+template <typename Make>
+Timing measure(int repetitions, Make&& make) {
+    make().reset();  // Прогрев
+    vector<double> parseTimes, destroyTimes;
+    for (int i = 0; i < repetitions; i++) {
+        auto start = chrono::steady_clock::now();
+        auto tree = make();
+        auto parsed = chrono::steady_clock::now();
+        tree.reset();
+        auto destroyed = chrono::steady_clock::now();
+        parseTimes.push_back(chrono::duration<double, milli>(parsed - start).count());
+        destroyTimes.push_back(chrono::duration<double, milli>(destroyed - parsed).count());
+    }
+    sort(parseTimes.begin(), parseTimes.end());
+    sort(destroyTimes.begin(), destroyTimes.end());
+    return {parseTimes[repetitions / 2], destroyTimes[repetitions / 2]};
+}
+
+void printTiming(const string& name, const Timing& timing, double megabytes) {
+    double total = timing.parseMs + timing.destroyMs;
+    cout << "  " << name << "разбор " << timing.parseMs << " мс, освобождение "
+         << timing.destroyMs << " мс, всего " << total << " мс, "
+         << megabytes / (total / 1000) << " МБ/с\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t records = argc > 1 ? stoul(argv[1]) : 100000;
+    int repetitions = argc > 2 ? stoi(argv[2]) : 7;
+    
+    string corpus = makeCorpus(records);
+    double megabytes = corpus.size() / 1e6;
+    
+    Timing heap = measure(repetitions, [&]() {
+        return make_unique<JsonValue>(parseJson(corpus));
+    });
+    Timing arena = measure(repetitions, [&]() {
+        return make_unique<JsonArenaDocument>(corpus);
+    });
+    
+    cout << fixed << setprecision(1);
+    cout << "Записей: " << records << ", объём: " << megabytes << " МБ, медиана из "
+         << repetitions << " прогонов\n";
+    printTiming("куча:  ", heap, megabytes);
+    printTiming("арена: ", arena, megabytes);
+    return 0;
+}
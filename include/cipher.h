@@ -2,8 +2,10 @@
 #define CIPHER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <cstdint>
 
 /**
  * @file cipher.h
@@ -43,6 +45,48 @@ std::string encryptCaesar(const std::string& text, int key, char lang);
  */
 std::string decryptCaesar(const std::string& text, int key, char lang);
 
+/**
+ * @brief Шифрует текст на месте, без выделения памяти
+ *
+ * Длина текста не меняется: латиница однобайтовая, а все буквы русского
+ * алфавита в UTF-8 занимают ровно два байта.
+ *
+ * @param text Текст, который будет заменён зашифрованным
+ * @param key Величина сдвига (1-25 для английского, 1-32 для русского)
+ * @param lang Язык текста: 'E' для английского, 'R' для русского
+ * @throw std::invalid_argument если ключ не в допустимом диапазоне
+ */
+void encryptCaesarInPlace(std::string& text, int key, char lang);
+
+/**
+ * @brief Дешифрует текст на месте, без выделения памяти
+ *
+ * @see encryptCaesarInPlace
+ */
+void decryptCaesarInPlace(std::string& text, int key, char lang);
+
+/**
+ * @brief Шифрует текст в буфер вызывающей стороны
+ *
+ * Буфер out должен вмещать text.size() байтов; out может совпадать
+ * с text.data(). Завершающий ноль не записывается.
+ *
+ * @param text Исходный текст
+ * @param out Буфер для результата
+ * @param key Величина сдвига (1-25 для английского, 1-32 для русского)
+ * @param lang Язык текста: 'E' для английского, 'R' для русского
+ * @return Количество записанных байтов (всегда text.size())
+ * @throw std::invalid_argument если ключ не в допустимом диапазоне
+ */
+size_t encryptCaesar(std::string_view text, char* out, int key, char lang);
+
+/**
+ * @brief Дешифрует текст в буфер вызывающей стороны
+ *
+ * @see encryptCaesar(std::string_view, char*, int, char)
+ */
+size_t decryptCaesar(std::string_view text, char* out, int key, char lang);
+
 /**
  * @brief Проверяет, находится ли ключ в допустимом диапазоне
  *
@@ -76,4 +120,115 @@ int getAlphabetSize(char lang);
  */
 std::string getKeyRangeError(char lang);
 
+// === Подбор ключа по частотам букв ===
+
+/**
+ * @brief Гистограмма букв текста без учёта регистра
+ *
+ * english[i] — число вхождений i-й буквы латиницы (a..z), russian[i] —
+ * i-й буквы русского алфавита (а..я, ё — седьмая). Остальные символы не
+ * учитываются.
+ */
+struct LetterHistogram {
+    uint64_t english[26] = {};
+    uint64_t russian[33] = {};
+    uint64_t englishLetters = 0;
+    uint64_t russianLetters = 0;
+};
+
+/**
+ * @brief Строит гистограмму букв за один проход по тексту
+ *
+ * @param text Текст в UTF-8
+ * @return Гистограмма латиницы и кириллицы
+ */
+LetterHistogram buildLetterHistogram(std::string_view text);
+
+/**
+ * @brief Оценивает все ключи языка по гистограмме шифртекста
+ *
+ * Для ключа key буква j открытого текста переходит в букву (j + key) mod n,
+ * поэтому оценка — χ² между сдвинутой гистограммой и частотами букв языка.
+ * Текст не читается: O(n²) по размеру алфавита n.
+ *
+ * @param histogram Гистограмма шифртекста
+ * @param lang Язык: 'E' или 'R'
+ * @return χ² для ключей 0..n-1 (меньше — правдоподобнее); ключ 0 — текст не сдвинут
+ * @throw std::invalid_argument если язык не поддерживается
+ */
+std::vector<double> scoreCaesarKeys(const LetterHistogram& histogram, char lang);
+
+/**
+ * @brief Результат подбора ключа
+ */
+struct CaesarCrackResult {
+    char lang = 'E';          // Язык, по алфавиту которого подобран ключ
+    int key = 0;              // Ключ шифрования; 0 — текст не сдвинут
+    double chiSquared = 0;    // Оценка лучшего ключа
+    uint64_t letters = 0;     // Букв этого алфавита в тексте
+    std::string text;         // Расшифрованный текст (только crackCaesar)
+};
+
+/**
+ * @brief Подбирает ключ шифртекста, не расшифровывая его
+ *
+ * Один проход по тексту строит гистограмму, затем ключи оцениваются по
+ * ней (scoreCaesarKeys): O(длина + n²), а не O(длина × n).
+ *
+ * @param text Шифртекст в UTF-8
+ * @param lang 'E', 'R' или 0 — язык алфавита, букв которого в тексте больше
+ * @return Язык, ключ и его оценка; поле text пустое
+ * @throw std::invalid_argument если язык не поддерживается
+ */
+CaesarCrackResult findCaesarKey(std::string_view text, char lang = 0);
+
+/**
+ * @brief Подбирает ключ и расшифровывает текст только им
+ *
+ * @see findCaesarKey
+ */
+CaesarCrackResult crackCaesar(std::string_view text, char lang = 0);
+
+/**
+ * @brief Реализация горячего цикла для английского текста
+ *
+ * Scalar — таблица трансляции, SSE2/AVX2 — векторная обработка
+ * по 16/32 байта. Все ядра дают побайтово одинаковый результат.
+ */
+enum class CipherKernel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/**
+ * @brief Проверяет, поддерживает ли процессор указанное ядро (CPUID)
+ */
+bool isCipherKernelSupported(CipherKernel kernel);
+
+/**
+ * @brief Возвращает самое быстрое ядро, доступное на текущем процессоре
+ */
+CipherKernel detectCipherKernel();
+
+/**
+ * @brief Возвращает ядро, используемое encryptCaesar/decryptCaesar
+ *
+ * По умолчанию равно detectCipherKernel().
+ */
+CipherKernel getCipherKernel();
+
+/**
+ * @brief Принудительно выбирает ядро (для тестов и бенчмарков)
+ *
+ * @param kernel Ядро для использования
+ * @throw std::invalid_argument если ядро не поддерживается процессором
+ */
+void setCipherKernel(CipherKernel kernel);
+
+/**
+ * @brief Возвращает имя ядра: "scalar", "sse2" или "avx2"
+ */
+std::string getCipherKernelName(CipherKernel kernel);
+
 #endif // CIPHER_H
@@ -2,9 +2,13 @@
 #define JSON_PARSER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <memory>
+#include <istream>
+#include <ostream>
+#include <variant>
+#include <memory_resource>
 
 /**
  * @file json_parser.h
@@ -27,39 +31,146 @@ enum class JsonType {
     Object      // объект
 };
 
+class JsonValue;
+
+// Контейнеры используют std::pmr: по умолчанию память берётся из обычной кучи,
+// а при разборе в арену (JsonArenaDocument) — из её монотонного буфера
+using JsonArray = std::pmr::vector<JsonValue>;                                  // для Array
+
 /**
- * @brief Простое представление JSON значения
+ * @brief Объект JSON: пары ключ/значение в одном непрерывном массиве
+ *
+ * В записях 2–6 ключей, поэтому вместо дерева (узел на каждый ключ)
+ * пары хранятся в векторе, отсортированном по ключу. Поиск двоичный,
+ * обход идёт в порядке ключей, как у std::map, поэтому вывод
+ * jsonToString детерминирован.
+ *
+ * Вставка нового ключа сдвигает пары: ссылки и итераторы на элементы
+ * объекта после неё недействительны (как у std::vector).
  */
-struct JsonValue {
-    JsonType type;
+class JsonObject {
+public:
+    using value_type = std::pair<std::pmr::string, JsonValue>;
+    using iterator = std::pmr::vector<value_type>::iterator;
+    using const_iterator = std::pmr::vector<value_type>::const_iterator;
+    
+    JsonObject() = default;
+    explicit JsonObject(std::pmr::memory_resource* resource) : items(resource) {}
+    
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_t size() const;
+    bool empty() const;
+    void reserve(size_t count);
+    
+    // Поиск по ключу; end(), если ключа нет
+    iterator find(std::string_view key);
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
     
-    // В зависимости от type используется один из полей:
-    bool boolValue;                                    // для Boolean
-    double numberValue;                                // для Number
-    std::string stringValue;                           // для String
-    std::vector<JsonValue> arrayValue;                 // для Array
-    std::map<std::string, JsonValue> objectValue;      // для Object
+    // @throw std::out_of_range если ключа нет
+    JsonValue& at(std::string_view key);
+    const JsonValue& at(std::string_view key) const;
+    
+    // Значение по ключу; отсутствующий ключ добавляется со значением null
+    JsonValue& operator[](std::string_view key);
+    
+    /**
+     * @brief Записывает значение по ключу, заменяя прежнее
+     * @return Итератор на пару и true, если ключ был добавлен
+     */
+    std::pair<iterator, bool> insert_or_assign(std::string_view key, JsonValue value);
+    
+    // Удаляет ключ; возвращает число удалённых пар (0 или 1)
+    size_t erase(std::string_view key);
+    
+private:
+    std::pmr::vector<value_type> items;   // Отсортированы по ключу
+};
+
+/**
+ * @brief Представление JSON значения
+ *
+ * Хранится только активная альтернатива (std::variant), поэтому узел
+ * занимает размер наибольшей из них плюс индекс. Короткие строки
+ * (до 15 байтов) хранятся внутри std::string без отдельной аллокации.
+ */
+class JsonValue {
+private:
+    std::variant<std::monostate,      // Null
+                 bool,                // Boolean
+                 double,              // Number
+                 std::string,         // String (собственная копия)
+                 std::string_view,    // String, заимствованная из чужого буфера
+                 JsonArray,           // Array
+                 JsonObject> data;    // Object
     
+public:
     // Конструкторы
-    JsonValue() : type(JsonType::Null) {}
-    JsonValue(bool b) : type(JsonType::Boolean), boolValue(b) {}
-    JsonValue(double n) : type(JsonType::Number), numberValue(n) {}
-    JsonValue(const std::string& s) : type(JsonType::String), stringValue(s) {}
+    JsonValue() {}
+    JsonValue(bool b) : data(b) {}
+    JsonValue(double n) : data(n) {}
+    JsonValue(const std::string& s) : data(s) {}
+    JsonValue(std::string&& s) : data(std::move(s)) {}
+    explicit JsonValue(JsonArray a) : data(std::move(a)) {}
+    explicit JsonValue(JsonObject o) : data(std::move(o)) {}
+    
+    /**
+     * @brief Создаёт строку, которая не копирует байты, а ссылается на них
+     *
+     * Буфер должен жить дольше значения (см. JsonDocument).
+     */
+    static JsonValue borrow(std::string_view s);
+    
+    /**
+     * @brief Тип хранимого значения
+     */
+    JsonType type() const;
+    
+    /**
+     * @brief true, если это строка, заимствованная из чужого буфера
+     */
+    bool isBorrowed() const;
     
     // Получить значение как строку (для удобства)
     std::string asString() const;
     double asNumber() const;
     bool asBoolean() const;
+    
+    // Строка без копирования (собственная или заимствованная); пусто для не-String
+    std::string_view asStringView() const;
+    
+    /**
+     * @brief Делает значение собственной строкой и возвращает её для изменения
+     *
+     * Заимствованная строка копируется, значение другого типа заменяется
+     * пустой строкой.
+     */
+    std::string& ownedString();
+    
+    // Доступ к массиву и объекту
+    // @throw std::runtime_error если значение другого типа
+    JsonArray& asArray();
+    const JsonArray& asArray() const;
+    JsonObject& asObject();
+    const JsonObject& asObject() const;
 };
 
 /**
  * @brief Парсит JSON строку и возвращает корневое значение
  *
+ * Входной текст не копируется. Если borrowStrings = true, строки без
+ * экранирования не копируются, а ссылаются на jsonStr (JsonValue::borrow),
+ * поэтому буфер должен жить дольше результата.
+ *
  * @param jsonStr JSON-строка для парсинга
+ * @param borrowStrings Заимствовать строки из jsonStr вместо копирования
  * @return JsonValue с результатом парсинга
  * @throw std::runtime_error если JSON невалидный (с указанием позиции)
  */
-JsonValue parseJson(const std::string& jsonStr);
+JsonValue parseJson(std::string_view jsonStr, bool borrowStrings = false);
 
 /**
  * @brief Сохраняет JsonValue в JSON строку
@@ -70,18 +181,134 @@ JsonValue parseJson(const std::string& jsonStr);
  */
 std::string jsonToString(const JsonValue& value, bool pretty = true);
 
+/**
+ * @brief Дописывает text в out как JSON-строку в кавычках с экранированием
+ *
+ * Тот же формат, что у строк в jsonToString(); для тех, кто собирает
+ * JSON вручную без дерева JsonValue.
+ */
+void appendJsonString(std::string& out, std::string_view text);
+
 /**
  * @brief Загружает JSON из файла
  *
+ * На Linux файл отображается в память (mmap) и разбирается без
+ * промежуточных копий; строки результата — собственные копии.
+ *
  * @param filename Путь к файлу
  * @return JsonValue с содержимым файла
  * @throw std::runtime_error если файл не может быть прочитан или JSON невалидный
  */
 JsonValue loadJsonFile(const std::string& filename);
 
+class MappedFile;
+
+/**
+ * @brief Разбирать ли документ при загрузке
+ */
+enum class JsonParseMode {
+    Full,       // Дерево строится сразу (root())
+    OnDemand    // Текст не разбирается: записи читаются курсором (JsonLazyObject)
+};
+
+/**
+ * @brief Документ JSON, разобранный прямо из отображённого в память файла
+ *
+ * Строки без экранирования в дереве заимствованы из отображения
+ * (JsonValue::borrow), поэтому загрузка стоит только page faults.
+ * Отображение живёт, пока жив документ; копии значений, содержащие
+ * заимствованные строки, не должны его пережить.
+ */
+class JsonDocument {
+private:
+    std::unique_ptr<MappedFile> file;
+    JsonValue rootValue;
+    
+public:
+    JsonDocument();
+    
+    /**
+     * @brief Отображает файл в память и разбирает его
+     *
+     * В режиме OnDemand текст не разбирается, root() — null; записи
+     * берутся из text() (splitJsonArray, JsonLazyObject).
+     *
+     * @param filename Путь к файлу
+     * @param mode Разбирать ли документ сразу
+     * @throw std::runtime_error если файл не может быть прочитан или JSON невалидный
+     */
+    explicit JsonDocument(const std::string& filename, JsonParseMode mode = JsonParseMode::Full);
+    
+    /**
+     * @brief Читает поток (например, stdin) до конца и разбирает его
+     *
+     * @param input Поток с JSON
+     * @param mode Разбирать ли документ сразу
+     * @throw std::runtime_error при ошибке чтения или если JSON невалидный
+     */
+    explicit JsonDocument(std::istream& input, JsonParseMode mode = JsonParseMode::Full);
+    
+    JsonDocument(JsonDocument&& other) noexcept;
+    JsonDocument& operator=(JsonDocument&& other) noexcept;
+    ~JsonDocument();
+    
+    JsonValue& root();
+    const JsonValue& root() const;
+    
+    /**
+     * @brief Исходный текст документа
+     */
+    std::string_view text() const;
+    
+    /**
+     * @brief Размер исходного текста в байтах
+     */
+    size_t size() const;
+};
+
+/**
+ * @brief Документ JSON, все узлы и строки которого лежат в одном буфере арены
+ *
+ * Разбор идёт в std::pmr::monotonic_buffer_resource: массивы, объекты,
+ * ключи и байты строк выделяются из неё, а в обычной куче не остаётся
+ * ничего. Поэтому при уничтожении документа деструкторы узлов не
+ * вызываются — арена освобождается целиком, за O(1) относительно числа узлов.
+ *
+ * Дерево доступно только для чтения: изменение могло бы выделить память
+ * вне арены. Копия значения (JsonValue copy = doc.root()) размещает
+ * контейнеры в обычной куче и может изменяться, но её строки по-прежнему
+ * заимствованы из арены, поэтому копия не должна пережить документ.
+ */
+class JsonArenaDocument {
+private:
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+    const JsonValue* rootValue;   // Размещён в арене, деструктор не вызывается
+    
+public:
+    /**
+     * @brief Разбирает JSON в новую арену
+     *
+     * Входной буфер после разбора не нужен: строки копируются в арену.
+     *
+     * @param jsonStr JSON-строка для парсинга
+     * @throw std::runtime_error если JSON невалидный
+     */
+    explicit JsonArenaDocument(std::string_view jsonStr);
+    
+    JsonArenaDocument(JsonArenaDocument&& other) noexcept;
+    JsonArenaDocument& operator=(JsonArenaDocument&& other) noexcept;
+    ~JsonArenaDocument();
+    
+    const JsonValue& root() const;
+};
+
 /**
  * @brief Сохраняет JsonValue в файл
  *
+ * Данные пишутся во временный файл, который затем атомарно заменяет целевой.
+ * Благодаря этому можно сохранять в файл, открытый как JsonDocument:
+ * старое содержимое остаётся доступным отображению.
+ *
  * @param filename Путь к файлу для сохранения
  * @param value JSON значение для сохранения
  * @param pretty Если true, добавляет красивое форматирование
@@ -96,6 +323,239 @@ void saveJsonFile(const std::string& filename, const JsonValue& value, bool pret
  * @param errorMsg Если парсинг не удался, здесь будет сообщение об ошибке
  * @return true если JSON валиден, false иначе
  */
-bool isValidJson(const std::string& jsonStr, std::string& errorMsg);
+bool isValidJson(std::string_view jsonStr, std::string& errorMsg);
+
+/**
+ * @brief Потоковое чтение массива JSON верхнего уровня по одному элементу
+ *
+ * Поток читается блоками; в памяти одновременно находится только текст
+ * текущего элемента, поэтому пиковое потребление памяти — O(размер элемента),
+ * а не O(размер файла).
+ */
+class JsonArrayReader {
+private:
+    std::istream& in;
+    std::string chunk;          // Текущий блок входного потока
+    size_t chunkPos;
+    std::string elementText;    // Текст текущего элемента
+    bool started;
+    bool finished;
+    
+    int peekChar();
+    int getChar();
+    int skipWhitespace();
+    void readElementText();
+    
+public:
+    /**
+     * @brief Создаёт читателя поверх входного потока
+     *
+     * @param input Поток, содержащий массив JSON
+     */
+    explicit JsonArrayReader(std::istream& input);
+    
+    /**
+     * @brief Читает следующий элемент массива
+     *
+     * @param value Сюда записывается разобранный элемент
+     * @return true если элемент прочитан, false если массив закончился
+     * @throw std::runtime_error если JSON невалидный или верхний уровень не массив
+     */
+    bool next(JsonValue& value);
+    
+    /**
+     * @brief Читает текст следующего элемента, не разбирая его
+     *
+     * Элемент проверяется по грамматике JSON, но дерево не строится.
+     * Текст без окружающих пробелов действителен до следующего вызова.
+     *
+     * @param text Сюда записывается текст элемента
+     * @return true если элемент прочитан, false если массив закончился
+     * @throw std::runtime_error если верхний уровень не массив или JSON невалидный
+     */
+    bool nextText(std::string_view& text);
+};
+
+/**
+ * @brief Делит массив JSON верхнего уровня на тексты элементов, не разбирая их
+ *
+ * Элементы проверяются по грамматике JSON без построения дерева:
+ * литералы сравниваются целиком, числа проверяются по грамматике,
+ * закрывающие скобки должны соответствовать открывающим. Строки
+ * пропускаются до закрывающей кавычки без раскрытия экранирования.
+ *
+ * @param json Текст документа
+ * @param elements Сюда добавляются тексты элементов (срезы json)
+ * @return false, если верхний уровень не массив (тогда текст не проверяется)
+ * @throw std::runtime_error если массив или его элементы невалидны
+ */
+bool splitJsonArray(std::string_view json, std::vector<std::string_view>& elements);
+
+/**
+ * @brief Курсор по полям объекта JSON верхнего уровня
+ *
+ * Поле отдаётся как сырой текст ключа (без кавычек, экранирование не
+ * раскрывается) и значения. Значения не разбираются, а пропускаются
+ * с проверкой, как в splitJsonArray().
+ */
+class JsonFieldCursor {
+private:
+    std::string_view text;
+    size_t pos;
+    bool first;
+    bool finished;
+    bool checked;       // Текст уже проверен, значения не проверяются повторно
+    
+public:
+    /**
+     * @param objectJson Текст объекта; должен жить дольше курсора
+     * @param validated Текст уже проверен (splitJsonArray, nextText), и
+     *        значения пропускаются без повторной проверки
+     * @throw std::runtime_error если текст не начинается с '{'
+     */
+    explicit JsonFieldCursor(std::string_view objectJson, bool validated = false);
+    
+    /**
+     * @brief Переходит к следующему полю
+     *
+     * @param key Сюда записывается ключ
+     * @param value Сюда записывается текст значения
+     * @return true если поле прочитано, false если объект закончился
+     * @throw std::runtime_error если объект или значение поля невалидны
+     */
+    bool next(std::string_view& key, std::string_view& value);
+};
+
+/**
+ * @brief Объект JSON, поля которого разбираются по требованию
+ *
+ * Объект — это срез исходного текста. Поле ищется курсором
+ * (JsonFieldCursor) и разбирается только при обращении к нему;
+ * остальные пропускаются без раскрытия строк и без аллокаций.
+ * Изменённые и добавленные поля хранятся отдельно. При записи
+ * (JsonArrayWriter::write) неизменённые поля копируются из исходного
+ * текста как есть, а объект без изменений — целиком.
+ *
+ * Ключи сравниваются как есть, без раскрытия экранирования. Из
+ * повторяющихся ключей, как и в parseJson(), действует последний —
+ * и при поиске, и при записи.
+ * Текст должен быть проверенным объектом JSON (splitJsonArray,
+ * JsonArrayReader::nextText) и жить дольше объекта.
+ */
+class JsonLazyObject {
+private:
+    std::string_view source = "{}";
+    JsonObject changes;         // Изменённые и добавленные поля
+    
+public:
+    JsonLazyObject() = default;
+    
+    /**
+     * @param objectJson Текст объекта JSON (начинается с '{')
+     */
+    explicit JsonLazyObject(std::string_view objectJson);
+    
+    /**
+     * @brief Исходный текст объекта
+     */
+    std::string_view text() const;
+    
+    /**
+     * @brief Значение поля, разобранное при обращении
+     *
+     * Строки без экранирования заимствуются из исходного текста;
+     * изменённое поле возвращается копией.
+     *
+     * @param key Имя поля
+     * @param value Сюда записывается значение
+     * @return true если поле есть
+     * @throw std::runtime_error если текст объекта или значения поля невалидный
+     */
+    bool get(std::string_view key, JsonValue& value) const;
+    
+    /**
+     * @brief Резервирует место под count изменённых полей
+     */
+    void reserve(size_t count);
+    
+    /**
+     * @brief Записывает значение поля, заменяя исходное
+     */
+    void insert_or_assign(std::string_view key, JsonValue value);
+    
+    /**
+     * @brief Изменённые и добавленные поля
+     */
+    const JsonObject& changedFields() const;
+    
+    /**
+     * @brief true, если поля изменялись
+     */
+    bool modified() const;
+};
+
+/**
+ * @brief Потоковая запись массива JSON по одному элементу
+ *
+ * Элементы JsonValue и JsonObject форматируются так же, как в
+ * jsonToString(). Элементы writeRaw() и неизменённые части
+ * JsonLazyObject копируются как есть, в исходном форматировании.
+ */
+class JsonArrayWriter {
+private:
+    std::ostream& out;
+    bool pretty;
+    size_t count;
+    bool finished;
+    std::string buffer;    // Ещё не записанный в поток текст
+    std::vector<std::pair<std::string_view, std::string_view>> rawFields;  // Поля write(JsonLazyObject)
+    
+public:
+    /**
+     * @brief Создаёт писателя и выводит открывающую скобку
+     *
+     * @param output Поток для записи
+     * @param pretty Если true, добавляет красивое форматирование
+     */
+    JsonArrayWriter(std::ostream& output, bool pretty = true);
+    
+    /**
+     * @brief Добавляет очередной элемент массива
+     *
+     * Текст уходит в поток порциями по 64 КБ; остаток — в finish().
+     */
+    void write(const JsonValue& value);
+    
+    /**
+     * @brief То же для объекта — без копирования его в JsonValue
+     */
+    void write(const JsonObject& object);
+    
+    /**
+     * @brief То же для объекта, разбираемого по требованию
+     *
+     * Объект без изменений пишется как есть (writeRaw). Иначе поля
+     * выводятся по порядку ключей, как у JsonObject: неизменённые
+     * значения копируются из исходного текста, изменённые сериализуются.
+     */
+    void write(const JsonLazyObject& object);
+    
+    /**
+     * @brief Добавляет уже сериализованный элемент как есть
+     *
+     * @param json Текст элемента JSON
+     */
+    void writeRaw(std::string_view json);
+    
+    /**
+     * @brief Закрывает массив; повторные вызовы ничего не делают
+     */
+    void finish();
+    
+    /**
+     * @brief Количество записанных элементов
+     */
+    size_t size() const;
+};
 
 #endif // JSON_PARSER_H
@@ -0,0 +1,113 @@
+#ifndef LOG_ROTATION_H
+#define LOG_ROTATION_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include "logger.h"
+#include "log_segment.h"
+
+/**
+ * @file log_rotation.h
+ * @brief Ротация лога: нумерованные сегменты и манифест
+ *
+ * Заполненный активный файл (например, operations.log) переименовывается
+ * в operations.log.N, а с compress — переводится в бинарный сегмент
+ * operations.log.N.seg (см. log_segment.h). Список закрытых сегментов
+ * от старых к новым хранится в манифесте operations.log.manifest:
+ *
+ * {"next": 3, "segments": [
+ *   {"bytes": 36011, "compressed": true, "entries": 1000, "file": "operations.log.1.seg",
+ *    "from": "2025-12-21T22:05:30", "to": "2025-12-21T23:10:02"}, ...]}
+ *
+ * Имена сегментов записаны относительно каталога лога.
+ */
+
+/**
+ * @brief Закрытый сегмент лога
+ */
+struct SealedLogSegment {
+    std::string file;           // Имя файла относительно каталога лога
+    bool compressed = false;    // true — бинарный сегмент, false — NDJSON
+    uint64_t entries = 0;
+    int64_t firstNs = 0;        // Время первой и последней записи
+    int64_t lastNs = 0;
+    uint64_t bytes = 0;         // Размер файла сегмента
+};
+
+/**
+ * @brief Манифест сегментов одного файла лога
+ */
+struct LogManifest {
+    uint32_t next = 1;                      // Номер следующего сегмента
+    std::vector<SealedLogSegment> segments; // От старых к новым
+};
+
+/**
+ * @brief Имя файла манифеста: logFile + ".manifest"
+ */
+std::string logManifestFile(const std::string& logFile);
+
+/**
+ * @brief Путь к файлу сегмента (в каталоге лога)
+ */
+std::string sealedSegmentPath(const std::string& logFile, const SealedLogSegment& segment);
+
+/**
+ * @brief Читает манифест; если его нет — пустой манифест
+ *
+ * @throw std::runtime_error если манифест повреждён
+ */
+LogManifest loadLogManifest(const std::string& logFile);
+
+/**
+ * @brief Записывает манифест (временный файл + rename)
+ *
+ * @throw std::runtime_error при ошибке записи
+ */
+void saveLogManifest(const std::string& logFile, const LogManifest& manifest);
+
+/**
+ * @brief Закрывает активный файл лога в очередной сегмент
+ *
+ * Файл переименовывается в logFile.N; с options.compress он переводится
+ * в бинарный сегмент logFile.N.seg, а NDJSON удаляется. Сегмент
+ * добавляется в manifest, лишние старые сегменты (options.maxSegments)
+ * удаляются с диска и из манифеста. Сам манифест не сохраняется.
+ * При ошибке активный файл и manifest не меняются.
+ *
+ * @param stats Число записей и время первой/последней записи файла, если
+ *              они известны без чтения; иначе (и всегда при сжатии, когда
+ *              файл читается целиком) они считаются по файлу
+ * @throw std::runtime_error при ошибке переименования или сжатия
+ */
+void sealLogFile(const std::string& logFile, LogManifest& manifest,
+                 const LogRotationOptions& options,
+                 const std::optional<SealedLogSegment>& stats = std::nullopt);
+
+/**
+ * @brief Читает историю: сегменты из манифеста и активный файл
+ *
+ * @param lastEntries Вернуть только столько последних записей (0 — все);
+ *                    более старые сегменты тогда не читаются
+ * @throw std::runtime_error если сегмент не читается
+ */
+std::vector<LogEntry> readLogHistory(const std::string& logFile, size_t lastEntries = 0);
+
+/**
+ * @brief Выполняет запрос по всей истории лога
+ *
+ * Сегменты, интервал времени которых по манифесту не пересекается с
+ * запросом, не открываются. Для NDJSON-файлов (активного и несжатых
+ * сегментов) запрос идёт через бинарный сегмент рядом с ними, который
+ * пересобирается, если устарел.
+ *
+ * @param rebuilt Число пересобранных бинарных сегментов
+ * @param total Число записей во всей истории
+ * @throw std::runtime_error при ошибке чтения
+ */
+std::vector<LogEntry> queryLogHistory(const std::string& logFile, const LogQuery& query,
+                                      size_t& rebuilt, size_t& total);
+
+#endif // LOG_ROTATION_H
@@ -0,0 +1,111 @@
+#ifndef LOG_SEGMENT_H
+#define LOG_SEGMENT_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <optional>
+#include <cstdint>
+#include <climits>
+#include "logger.h"
+
+/**
+ * @file log_segment.h
+ * @brief Бинарные колоночные сегменты лога и запросы к ним
+ *
+ * Сегмент хранит записи лога, отсортированные по времени, колонками
+ * фиксированной ширины:
+ * - время (int64, нс от эпохи), id и ключ (int32);
+ * - операция, статус и сообщение — коды (uint32) в словаре строк;
+ * - индекс по id: пары (id, номер строки), отсортированные по id;
+ * - разреженный индекс: для каждого блока из blockRows строк — время
+ *   первой строки и первый id блока в индексе по id.
+ *
+ * Запрос по id или по интервалу времени бинарным поиском по разреженному
+ * индексу находит нужные блоки и читает с диска только их.
+ *
+ * Числа записаны в порядке байтов машины; файл с другим порядком
+ * байтов не открывается.
+ */
+
+/**
+ * @brief Условия выборки из лога; пустое условие не ограничивает
+ */
+struct LogQuery {
+    std::optional<int> id;                  // ID записи
+    std::optional<std::string> operation;   // "encrypt" / "decrypt"
+    int64_t fromNs = INT64_MIN;             // Начало интервала времени (включительно)
+    int64_t toNs = INT64_MAX;               // Конец интервала времени (не включительно)
+};
+
+/**
+ * @brief Сегмент лога, открытый для запросов
+ *
+ * При открытии читаются только заголовок, словарь и разреженный индекс;
+ * колонки читаются с диска по запросу.
+ */
+class LogSegment {
+private:
+    mutable std::ifstream file;
+    uint64_t rowCount = 0;
+    uint32_t blockRows = 0;
+    std::vector<std::string> dictionary;
+    std::vector<int64_t> blockFirstTime;    // Время первой строки каждого блока
+    std::vector<int32_t> blockFirstId;      // Первый id каждого блока индекса по id
+
+    // Читает count элементов колонки начиная со строки first
+    template <typename T>
+    void readColumn(uint64_t columnOffset, uint64_t first, uint64_t count, T* out) const;
+
+    // Собирает LogEntry для строки по уже прочитанным значениям колонок
+    LogEntry makeEntry(int64_t time, int32_t id, int32_t key,
+                       uint32_t operation, uint32_t status, uint32_t message) const;
+
+    // Код строки в словаре или -1
+    int64_t findCode(const std::string& text) const;
+
+public:
+    /**
+     * @brief Открывает сегмент
+     * @throw std::runtime_error если файл не открывается или повреждён
+     */
+    explicit LogSegment(const std::string& filename);
+
+    /**
+     * @brief Количество записей в сегменте
+     */
+    size_t size() const;
+
+    /**
+     * @brief Записи, удовлетворяющие всем условиям, в порядке времени
+     *
+     * С id читаются только блоки индекса по id с этим id и сами
+     * найденные строки; с интервалом времени — только блоки,
+     * пересекающиеся с ним. Без id и интервала сегмент читается целиком.
+     */
+    std::vector<LogEntry> query(const LogQuery& query) const;
+
+    /**
+     * @brief Записывает записи в сегмент (временный файл + rename)
+     *
+     * Записи сортируются по времени (устойчиво), строки интернируются.
+     *
+     * @param blockRows Строк в блоке разреженного индекса
+     * @throw std::runtime_error при ошибке записи
+     */
+    static void write(const std::string& filename, std::vector<LogEntry> entries,
+                      uint32_t blockRows = 1024);
+};
+
+/**
+ * @brief Пересобирает сегмент из NDJSON-лога, если он устарел
+ *
+ * Сегмент считается актуальным, если он существует и изменён не раньше
+ * файла лога.
+ *
+ * @return true, если сегмент был пересобран
+ * @throw std::runtime_error при ошибке чтения лога или записи сегмента
+ */
+bool refreshLogSegment(const std::string& logFile, const std::string& segmentFile);
+
+#endif // LOG_SEGMENT_H
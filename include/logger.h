@@ -3,6 +3,13 @@
 
 #include <string>
 #include <vector>
+#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
 #include "json_parser.h"
 
 /**
@@ -11,44 +18,201 @@
  *
  * Логирует все операции (шифрование/дешифрование) с временными метками
  * в формате JSON для последующего анализа.
+ *
+ * Файл лога — NDJSON: по одному JSON-объекту на строку. Запись только
+ * дописывается в конец файла, история при запуске не читается. Старый
+ * формат (один JSON-массив) читается loadFromFile() и переводится в
+ * NDJSON функцией convertLogFile().
+ *
+ * С ротацией (setRotation()) заполненный файл закрывается в нумерованный
+ * сегмент, описанный в манифесте (см. log_rotation.h).
  */
 
 /**
  * @brief Структура для одной записи логирования
+ *
+ * Время хранится числом, строка ISO 8601 формируется только при выводе
+ * и сериализации.
  */
 struct LogEntry {
-    std::string timestamp;      // ISO 8601 формат: YYYY-MM-DDTHH:MM:SS
+    int64_t timestampNs = 0;    // Наносекунды от эпохи (system_clock)
     std::string operation;      // "encrypt" или "decrypt"
-    int key;                    // Используемый ключ
-    int id;                     // ID записи из JSON
+    int key = 0;                // Используемый ключ
+    int id = 0;                 // ID записи из JSON
     std::string status;         // "успешно" или "ошибка"
     std::string message;        // Дополнительная информация (ошибки, примечания)
     
+    // Время в формате ISO 8601: YYYY-MM-DDTHH:MM:SS (локальное)
+    std::string timestamp() const;
+    
     // Конвертирует в JsonValue для сохранения
     JsonValue toJson() const;
     
+    /**
+     * @brief Дописывает запись в out строкой NDJSON (с '\n')
+     *
+     * Тот же JSON, что jsonToString(toJson(), false), но без построения
+     * дерева; числа пишутся как целые.
+     */
+    void appendJsonLine(std::string& out) const;
+    
     // Создаёт LogEntry из JsonValue
     static LogEntry fromJson(const JsonValue& value);
 };
 
+/**
+ * @brief Пороги фонового писателя лога
+ *
+ * Накопленные записи пишутся на диск одной порцией, как только их
+ * набралось batchEntries или прошло flushInterval с прошлой записи.
+ */
+struct AsyncLogOptions {
+    size_t batchEntries = 4096;
+    std::chrono::milliseconds flushInterval{200};
+};
+
+/**
+ * @brief Ротация файла лога и предел записей в памяти
+ *
+ * Активный файл закрывается в сегмент перед записью, если он уже занимает
+ * maxBytes или его первой записи не меньше maxAge. Нулевой порог не
+ * действует.
+ */
+struct LogRotationOptions {
+    uint64_t maxBytes = 0;                  // Размер активного файла, байт
+    std::chrono::seconds maxAge{0};         // Возраст активного файла
+    bool compress = false;                  // Сжимать закрытые сегменты в бинарный формат
+    size_t maxSegments = 0;                 // Хранить не больше сегментов (0 — все)
+    size_t maxEntriesInMemory = 10000;      // Записей в памяти (кольцевой буфер, 0 — без предела)
+};
+
+struct AsyncLogNode;
+
 /**
  * @brief Класс для управления логированием
+ *
+ * В синхронном режиме (по умолчанию) log() вызывается из одного потока.
+ * В асинхронном (startAsync()) log() можно вызывать из любых потоков:
+ * запись кладётся в lock-free очередь, а форматирует и пишет её на диск
+ * фоновый поток.
+ *
+ * В памяти хранятся только последние maxEntriesInMemory записей.
  */
 class Logger {
 private:
+    // Кольцевой буфер: при заполнении самая старая запись (entriesHead)
+    // заменяется новой
     std::vector<LogEntry> entries;
+    size_t entriesHead = 0;
+    mutable std::mutex entriesMutex;    // entries пополняет и фоновый поток
     std::string logFile;
+    std::ofstream output;       // Открывается для дозаписи при первой записи
+    std::string lineBuffer;     // Строка синхронного log(), переиспользуется
+    bool writable = true;       // false, если файл не открылся или не переведён в NDJSON
+    
+    // === Ротация ===
+    // Поля меняет только текущий писатель (log() или фоновый поток)
+    LogRotationOptions rotation;
+    uint64_t activeBytes = 0;       // Размер активного файла
+    uint64_t activeEntries = 0;     // Записей, добавленных в активный файл этим процессом
+    int64_t activeFirstNs = 0;      // Время первой и последней записи активного файла
+    int64_t activeLastNs = 0;
+    bool activeCounted = true;      // false — в файле есть записи прежних запусков:
+                                    // их число и время считаются при закрытии сегмента
+    
+    // === Асинхронный режим ===
+    // Очередь — стек Трайбера: производители добавляют узел CAS-ом,
+    // писатель забирает весь список одним exchange и разворачивает его
+    std::atomic<AsyncLogNode*> queueHead{nullptr};
+    std::atomic<uint64_t> enqueuedCount{0};
+    std::atomic<bool> asyncEnabled{false};
+    AsyncLogOptions asyncOptions;
+    std::thread writerThread;
+    std::mutex asyncMutex;              // Защищает поля ниже
+    std::condition_variable wakeWriter;
+    std::condition_variable batchWritten;
+    uint64_t writtenCount = 0;
+    uint64_t flushTarget = 0;           // saveToFile() ждёт, пока writtenCount его достигнет
+    bool stopRequested = false;
+    
+    // Открывает файл для дозаписи; false, если это не удалось
+    bool openForAppend();
+    
+    // Дописывает запись в файл и в память (вызывающий поток — единственный писатель)
+    void appendEntry(LogEntry&& entry, std::string& buffer);
+    
+    // Добавляет запись в кольцевой буфер (под entriesMutex)
+    void storeEntry(LogEntry&& entry);
+    
+    // Дописывает буфер в активный файл
+    void writeBuffer(const std::string& buffer, bool flush);
+    
+    // Перед записью момента nextNs закрывает активный файл в сегмент, если
+    // он достиг порога; pending — ещё не записанные строки активного файла
+    void rotateIfNeeded(int64_t nextNs, std::string& pending);
+    
+    // Закрывает активный файл в сегмент и обновляет манифест
+    void rotate();
+    
+    // Забирает очередь целиком и пишет её на диск; возвращает число записей
+    size_t drainQueue();
+    
+    void writerLoop();
     
 public:
     /**
      * @brief Конструктор логгера
+     *
+     * История из файла не загружается. Если файл в старом формате
+     * (JSON-массив), он один раз переводится в NDJSON, чтобы новые строки
+     * можно было дописывать в конец.
      * 
      * @param filename Путь к файлу логов
      */
     Logger(const std::string& filename = "operations.log");
     
+    /**
+     * @brief Останавливает фоновый поток, дописав очередь
+     */
+    ~Logger();
+    
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+    
+    /**
+     * @brief Включает асинхронный режим с фоновым писателем
+     *
+     * Повторный вызов ничего не делает.
+     */
+    void startAsync(const AsyncLogOptions& options = AsyncLogOptions());
+    
+    /**
+     * @brief Дописывает очередь на диск и возвращается в синхронный режим
+     *
+     * Вызывать, когда потоки-производители уже не пишут в лог.
+     */
+    void stopAsync();
+    
+    /**
+     * @brief true, если включён асинхронный режим
+     */
+    bool isAsync() const;
+    
+    /**
+     * @brief Задаёт пороги ротации и предел записей в памяти
+     *
+     * Вызывать до первой записи или в синхронном режиме. Если активный
+     * файл не пуст, он читается один раз, чтобы узнать его размер и
+     * время первой записи.
+     */
+    void setRotation(const LogRotationOptions& options);
+    
     /**
      * @brief Добавляет запись логирования
+     *
+     * Запись сразу дописывается в файл одной строкой (через буфер потока,
+     * на диск — при saveToFile() или завершении программы). В асинхронном
+     * режиме запись только ставится в очередь, время фиксируется сразу.
      * 
      * @param operation Тип операции ("encrypt" или "decrypt")
      * @param key Используемый ключ
@@ -60,23 +224,32 @@ public:
              const std::string& status, const std::string& message = "");
     
     /**
-     * @brief Сохраняет логи в файл
+     * @brief Сбрасывает дописанные строки в файл
+     *
+     * Файл не перезаписывается: записи уже дописаны вызовами log().
+     * В асинхронном режиме ждёт, пока фоновый поток запишет всё, что
+     * было поставлено в очередь до вызова.
      * 
      * @return true если успешно, false иначе
      */
     bool saveToFile();
     
     /**
-     * @brief Загружает логи из файла
+     * @brief Загружает историю из файла (NDJSON или старый JSON-массив)
+     *
+     * Заменяет записи в памяти содержимым сегментов из манифеста и
+     * активного файла, включая записи, дописанные в этой сессии. С
+     * пределом записей в памяти читаются только последние записи.
      * 
      * @return true если успешно, false иначе
      */
     bool loadFromFile();
     
     /**
-     * @brief Возвращает все записи логирования
+     * @brief Возвращает копию записей в памяти (текущей сессии или
+     *        загруженных) от старых к новым
      */
-    const std::vector<LogEntry>& getEntries() const;
+    std::vector<LogEntry> getEntries() const;
     
     /**
      * @brief Очищает все логи
@@ -101,4 +274,58 @@ public:
  */
 std::string getCurrentTimestamp();
 
+/**
+ * @brief Текущее время в наносекундах от эпохи (system_clock)
+ */
+int64_t currentTimeNs();
+
+/**
+ * @brief Дописывает момент времени в out как ISO 8601 (локальное время)
+ *
+ * Отформатированная секунда кэшируется в каждом потоке: localtime_r
+ * вызывается, только когда секунда сменилась, поэтому функция
+ * потокобезопасна и почти всегда сводится к копированию 19 байтов.
+ */
+void appendTimestamp(std::string& out, int64_t epochNs);
+
+/**
+ * @brief Момент времени как строка ISO 8601 (см. appendTimestamp)
+ */
+std::string formatTimestamp(int64_t epochNs);
+
+/**
+ * @brief Разбирает "YYYY-MM-DDTHH:MM:SS" (локальное время) в наносекунды
+ *
+ * @return false, если строка в другом формате
+ */
+bool parseTimestamp(const std::string& text, int64_t& epochNs);
+
+/**
+ * @brief Выводит записи лога таблицей в консоль
+ *
+ * @param fullTimestamp true — дата и время, false — только время
+ */
+void printLogEntries(const std::vector<LogEntry>& entries, bool fullTimestamp = false);
+
+/**
+ * @brief Читает файл лога в любом из форматов
+ *
+ * Формат определяется по первому значащему символу: '[' — старый
+ * JSON-массив, иначе NDJSON. Пустые и повреждённые строки NDJSON
+ * (например, недописанная при аварийном завершении) пропускаются.
+ *
+ * @throw std::runtime_error если файл не открывается или массив невалиден
+ */
+std::vector<LogEntry> readLogFile(const std::string& filename);
+
+/**
+ * @brief Переводит файл лога из старого формата (JSON-массив) в NDJSON
+ *
+ * Файл подменяется атомарно (временный файл + rename).
+ *
+ * @return true, если файл был в старом формате и переведён
+ * @throw std::runtime_error при ошибке чтения или записи
+ */
+bool convertLogFile(const std::string& filename);
+
 #endif // LOGGER_H
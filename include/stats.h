@@ -0,0 +1,96 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+
+/**
+ * @file stats.h
+ * @brief Статистика по этапам обработки (--stats)
+ *
+ * Этап отмечается объектом StageTimer на время его работы; повторные
+ * вызовы одного этапа (например, по записи в потоковом режиме)
+ * суммируются. Для этапа собираются время, байты, записи, число
+ * аллокаций (operator new во всех потоках) и рост пикового RSS.
+ *
+ * Пока статистика не включена, StageTimer ничего не измеряет, а
+ * подсчёт аллокаций сводится к одной проверке флага в operator new.
+ */
+
+/**
+ * @brief Итоги одного этапа
+ */
+struct StageStats {
+    std::string name;
+    uint64_t calls = 0;
+    int64_t wallNs = 0;
+    uint64_t bytes = 0;
+    uint64_t records = 0;
+    uint64_t allocations = 0;       // Вызовы operator new
+    uint64_t allocatedBytes = 0;
+    long peakRssKb = 0;             // Пиковый RSS процесса к концу этапа
+    long peakRssGrowthKb = 0;       // На сколько этап поднял пиковый RSS
+};
+
+/**
+ * @brief Включает сбор статистики; вызывать до начала обработки
+ */
+void enableStats();
+
+/**
+ * @brief true, если статистика собирается
+ */
+bool statsEnabled();
+
+/**
+ * @brief Замер этапа: от создания до уничтожения объекта
+ *
+ * Создаётся в главном потоке; аллокации рабочих потоков, запущенных
+ * внутри этапа, тоже относятся к нему. Этапы можно вкладывать: в итог
+ * (total) входят только внешние, поэтому вложенный не считается дважды.
+ */
+class StageTimer {
+private:
+    size_t index = SIZE_MAX;        // SIZE_MAX — статистика выключена
+    std::chrono::steady_clock::time_point start;
+    uint64_t startAllocations = 0;
+    uint64_t startAllocatedBytes = 0;
+    long startPeakRssKb = 0;
+    uint64_t bytes = 0;
+    uint64_t records = 0;
+    bool outer = false;             // Не вложен в другой этап; входит в итог
+
+public:
+    /**
+     * @param stage Имя этапа (строковый литерал)
+     */
+    explicit StageTimer(const char* stage);
+    ~StageTimer();
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+    void addBytes(uint64_t count) { bytes += count; }
+    void addRecords(uint64_t count) { records += count; }
+};
+
+/**
+ * @brief Итоги этапов в порядке их первого появления
+ */
+const std::vector<StageStats>& getStageStats();
+
+/**
+ * @brief Печатает таблицу этапов в stderr
+ */
+void printStats();
+
+/**
+ * @brief Сохраняет этапы и итог в JSON
+ *
+ * @throw std::runtime_error при ошибке записи
+ */
+void saveStatsJson(const std::string& filename);
+
+#endif // STATS_H
@@ -3,14 +3,22 @@
 #include <cctype>
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <numeric>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CAESAR_X86_SIMD 1
+#include <immintrin.h>
+#endif
 
 // === Константы для алфавитов ===
 const std::string ENGLISH_LOWER = "abcdefghijklmnopqrstuvwxyz";
 const std::string ENGLISH_UPPER = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
 
-// Русский алфавит: а..я (33 буквы, исключая ё)
-const std::string RUSSIAN_LOWER = "абвгдежзийклмнопрстуфхцчшщъыьэюя";
-const std::string RUSSIAN_UPPER = "АБВГДЕЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+// Русский алфавит: а..я (33 буквы, включая ё), в UTF-8 каждая буква — 2 байта
+const std::string RUSSIAN_LOWER = "абвгдеёжзийклмнопрстуфхцчшщъыьэюя";
+const std::string RUSSIAN_UPPER = "АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
 
 // === Вспомогательные функции ===
 
@@ -28,72 +36,363 @@ char shiftChar(char ch, int key, const std::string& alphabet) {
     return alphabet[newPos];
 }
 
+// === Таблицы трансляции ===
+
+/**
+ * @brief Таблица трансляции байтов для английского алфавита и одного ключа
+ *
+ * Каждый байт входного текста заменяется значением map[байт], поэтому
+ * горячий цикл шифрования сводится к одной загрузке и одной записи на байт.
+ */
+struct ShiftTable {
+    unsigned char map[256];
+};
+
 /**
- * @brief Проверяет, является ли символ буквой указанного языка
+ * @brief Строит таблицу трансляции для однобайтовых алфавитов
+ *
+ * Для каждого из 256 значений байта заранее вычисляется результат
+ * shiftChar(), так что поиск по алфавиту выполняется только при построении.
  */
-bool isLanguageLetter(char ch, char lang) {
-    if (lang == 'E' || lang == 'e') {
-        return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
-    } else if (lang == 'R' || lang == 'r') {
-        // Проверяем против русского алфавита
-        return RUSSIAN_LOWER.find(ch) != std::string::npos ||
-               RUSSIAN_UPPER.find(ch) != std::string::npos;
+ShiftTable buildShiftTable(int key, const std::string& lower, const std::string& upper) {
+    ShiftTable table;
+    for (int i = 0; i < 256; i++) {
+        char ch = static_cast<char>(i);
+        if (lower.find(ch) != std::string::npos) {
+            ch = shiftChar(ch, key, lower);
+        } else if (upper.find(ch) != std::string::npos) {
+            ch = shiftChar(ch, key, upper);
+        }
+        table.map[i] = static_cast<unsigned char>(ch);
     }
-    return false;
+    return table;
 }
 
-// === Основные функции ===
+/**
+ * @brief Таблица сдвига двухбайтового блока кириллицы для одного ключа
+ *
+ * Последовательность UTF-8 "0xD0/0xD1 + продолжение" задаёт код U+0400..U+047F.
+ * Индекс (младший бит ведущего байта, 6 бит продолжения) однозначно определяет
+ * код, а в ячейке хранятся два байта результата. Небуквенные коды блока
+ * отображаются сами в себя. Все 33 буквы кодируются двумя байтами, поэтому
+ * длина текста при сдвиге не меняется.
+ */
+struct CyrillicTable {
+    unsigned char map[128][2];
+};
 
-std::string encryptCaesar(const std::string& text, int key, char lang) {
-    // Валидация ключа
-    if (!isValidKey(key, lang)) {
-        throw std::invalid_argument(getKeyRangeError(lang));
+/**
+ * @brief Индекс в CyrillicTable для пары байтов UTF-8
+ */
+inline unsigned cyrillicIndex(unsigned char lead, unsigned char cont) {
+    return ((lead & 0x01u) << 6) | (cont & 0x3Fu);
+}
+
+/**
+ * @brief Строит таблицу сдвига кириллицы по строкам алфавита в UTF-8
+ */
+CyrillicTable buildCyrillicTable(int key, const std::string& lower, const std::string& upper) {
+    CyrillicTable table;
+    for (unsigned idx = 0; idx < 128; idx++) {
+        table.map[idx][0] = static_cast<unsigned char>(0xD0 | (idx >> 6));
+        table.map[idx][1] = static_cast<unsigned char>(0x80 | (idx & 0x3F));
     }
     
-    // Нормализуем язык
-    lang = std::toupper(lang);
+    for (const std::string* alphabet : {&lower, &upper}) {
+        size_t letters = alphabet->length() / 2;
+        for (size_t pos = 0; pos < letters; pos++) {
+            size_t newPos = (pos + key) % letters;
+            unsigned idx = cyrillicIndex((*alphabet)[pos * 2], (*alphabet)[pos * 2 + 1]);
+            table.map[idx][0] = static_cast<unsigned char>((*alphabet)[newPos * 2]);
+            table.map[idx][1] = static_cast<unsigned char>((*alphabet)[newPos * 2 + 1]);
+        }
+    }
+    return table;
+}
+
+/**
+ * @brief Набор таблиц для всех допустимых ключей обоих языков
+ *
+ * Ключ 0 соответствует тождественному преобразованию, поэтому индексом
+ * служит сам ключ. decryptCaesar() использует ключи (размер - key),
+ * которые попадают в те же диапазоны.
+ */
+struct ShiftTableCache {
+    ShiftTable english[26];
+    CyrillicTable russian[33];
     
-    std::string result;
-    result.reserve(text.length());  // Оптимизация памяти
-    
-    for (char ch : text) {
-        if (lang == 'E') {
-            // Обработка английского текста
-            if (ch >= 'a' && ch <= 'z') {
-                result += shiftChar(ch, key, ENGLISH_LOWER);
-            } else if (ch >= 'A' && ch <= 'Z') {
-                result += shiftChar(ch, key, ENGLISH_UPPER);
-            } else {
-                result += ch;  // Спецсимволы, цифры, пробелы
-            }
-        } else if (lang == 'R') {
-            // Обработка русского текста
-            if (RUSSIAN_LOWER.find(ch) != std::string::npos) {
-                result += shiftChar(ch, key, RUSSIAN_LOWER);
-            } else if (RUSSIAN_UPPER.find(ch) != std::string::npos) {
-                result += shiftChar(ch, key, RUSSIAN_UPPER);
-            } else {
-                result += ch;  // Спецсимволы, цифры, пробелы
-            }
+    ShiftTableCache() {
+        for (int key = 0; key < 26; key++) {
+            english[key] = buildShiftTable(key, ENGLISH_LOWER, ENGLISH_UPPER);
+        }
+        for (int key = 0; key < 33; key++) {
+            russian[key] = buildCyrillicTable(key, RUSSIAN_LOWER, RUSSIAN_UPPER);
+        }
+    }
+};
+
+/**
+ * @brief Возвращает кэш таблиц, строя его при первом вызове
+ *
+ * Инициализация локальной статической переменной потокобезопасна,
+ * поэтому кэш строится ровно один раз.
+ */
+const ShiftTableCache& getShiftTableCache() {
+    static const ShiftTableCache cache;
+    return cache;
+}
+
+const ShiftTable& getShiftTable(int key) {
+    return getShiftTableCache().english[key];
+}
+
+const CyrillicTable& getCyrillicTable(int key) {
+    return getShiftTableCache().russian[key];
+}
+
+/**
+ * @brief Применяет таблицу трансляции к буферу
+ */
+void applyShiftTable(const ShiftTable& table, const char* in, char* out, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        out[i] = static_cast<char>(table.map[static_cast<unsigned char>(in[i])]);
+    }
+}
+
+/**
+ * @brief Сдвигает русский текст в UTF-8
+ *
+ * Обрабатывается только двухбайтовый блок кириллицы (ведущие байты 0xD0/0xD1):
+ * код буквы находится одной загрузкой из CyrillicTable. Остальные байты
+ * (ASCII, другие последовательности UTF-8) копируются без изменений.
+ */
+void shiftRussian(const char* in, char* out, size_t length, int key) {
+    const CyrillicTable& table = getCyrillicTable(key);
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+    unsigned char* dst = reinterpret_cast<unsigned char*>(out);
+    
+    size_t i = 0;
+    while (i + 1 < length) {
+        unsigned char lead = src[i];
+        unsigned char cont = src[i + 1];
+        if ((lead & 0xFE) == 0xD0 && (cont & 0xC0) == 0x80) {
+            const unsigned char* letter = table.map[cyrillicIndex(lead, cont)];
+            dst[i] = letter[0];
+            dst[i + 1] = letter[1];
+            i += 2;
         } else {
-            throw std::invalid_argument("Неподдерживаемый язык. Используйте 'E' для английского или 'R' для русского.");
+            dst[i] = lead;
+            i++;
         }
     }
+    if (i < length) {
+        dst[i] = src[i];
+    }
+}
+
+// === Векторизованный английский путь (SSE2/AVX2) ===
+//
+// Для английского языка сдвиг вычисляется арифметически сразу для 16/32 байтов:
+//   idx    = (c | 0x20) - 'a'        — заглавные и строчные сводятся к одному диапазону
+//   letter = idx <= 25 (беззнаково)  — байт является латинской буквой
+//   nowrap = idx <= 25 - key         — после сдвига не нужен переход через 'z'
+//   c'     = c + (letter ? (nowrap ? key : key - 26) : 0)
+// Байты вне ASCII и небуквенные символы остаются без изменений, поэтому результат
+// побайтово совпадает с таблицей ShiftTable. Остаток буфера обрабатывается таблицей.
+
+#ifdef CAESAR_X86_SIMD
+
+__attribute__((target("sse2")))
+size_t shiftEnglishSSE2(const char* in, char* out, size_t length, int key) {
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    const __m128i lowerA = _mm_set1_epi8('a');
+    const __m128i maxIdx = _mm_set1_epi8(25);
+    const __m128i maxNoWrap = _mm_set1_epi8(static_cast<char>(25 - key));
+    const __m128i shift = _mm_set1_epi8(static_cast<char>(key));
+    const __m128i shiftWrap = _mm_set1_epi8(static_cast<char>(key - 26));
     
-    return result;
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i idx = _mm_sub_epi8(_mm_or_si128(v, caseBit), lowerA);
+        __m128i letter = _mm_cmpeq_epi8(_mm_min_epu8(idx, maxIdx), idx);
+        __m128i nowrap = _mm_cmpeq_epi8(_mm_min_epu8(idx, maxNoWrap), idx);
+        __m128i delta = _mm_or_si128(_mm_and_si128(nowrap, shift),
+                                     _mm_andnot_si128(nowrap, shiftWrap));
+        v = _mm_add_epi8(v, _mm_and_si128(letter, delta));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+    return i;
 }
 
-std::string decryptCaesar(const std::string& text, int key, char lang) {
+__attribute__((target("avx2")))
+size_t shiftEnglishAVX2(const char* in, char* out, size_t length, int key) {
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i lowerA = _mm256_set1_epi8('a');
+    const __m256i maxIdx = _mm256_set1_epi8(25);
+    const __m256i maxNoWrap = _mm256_set1_epi8(static_cast<char>(25 - key));
+    const __m256i shift = _mm256_set1_epi8(static_cast<char>(key));
+    const __m256i shiftWrap = _mm256_set1_epi8(static_cast<char>(key - 26));
+    
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i idx = _mm256_sub_epi8(_mm256_or_si256(v, caseBit), lowerA);
+        __m256i letter = _mm256_cmpeq_epi8(_mm256_min_epu8(idx, maxIdx), idx);
+        __m256i nowrap = _mm256_cmpeq_epi8(_mm256_min_epu8(idx, maxNoWrap), idx);
+        __m256i delta = _mm256_blendv_epi8(shiftWrap, shift, nowrap);
+        v = _mm256_add_epi8(v, _mm256_and_si256(letter, delta));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+    return i;
+}
+
+#endif // CAESAR_X86_SIMD
+
+bool isCipherKernelSupported(CipherKernel kernel) {
+    switch (kernel) {
+        case CipherKernel::Scalar:
+            return true;
+#ifdef CAESAR_X86_SIMD
+        case CipherKernel::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CipherKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+CipherKernel detectCipherKernel() {
+    if (isCipherKernelSupported(CipherKernel::AVX2)) return CipherKernel::AVX2;
+    if (isCipherKernelSupported(CipherKernel::SSE2)) return CipherKernel::SSE2;
+    return CipherKernel::Scalar;
+}
+
+/**
+ * @brief Активное ядро; выбирается по CPUID при первом обращении
+ */
+std::atomic<CipherKernel>& activeCipherKernel() {
+    static std::atomic<CipherKernel> kernel(detectCipherKernel());
+    return kernel;
+}
+
+CipherKernel getCipherKernel() {
+    return activeCipherKernel().load(std::memory_order_relaxed);
+}
+
+void setCipherKernel(CipherKernel kernel) {
+    if (!isCipherKernelSupported(kernel)) {
+        throw std::invalid_argument("Ядро шифра не поддерживается процессором: " +
+                                    getCipherKernelName(kernel));
+    }
+    activeCipherKernel().store(kernel, std::memory_order_relaxed);
+}
+
+std::string getCipherKernelName(CipherKernel kernel) {
+    switch (kernel) {
+        case CipherKernel::Scalar: return "scalar";
+        case CipherKernel::SSE2: return "sse2";
+        case CipherKernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Сдвигает английский текст активным ядром, хвост — по таблице
+ */
+void shiftEnglish(const char* in, char* out, size_t length, int key) {
+    size_t done = 0;
+#ifdef CAESAR_X86_SIMD
+    switch (getCipherKernel()) {
+        case CipherKernel::AVX2:
+            done = shiftEnglishAVX2(in, out, length, key);
+            break;
+        case CipherKernel::SSE2:
+            done = shiftEnglishSSE2(in, out, length, key);
+            break;
+        default:
+            break;
+    }
+#endif
+    applyShiftTable(getShiftTable(key), in + done, out + done, length - done);
+}
+
+/**
+ * @brief Сдвигает буфер на key позиций; in и out могут совпадать
+ *
+ * Язык должен быть уже нормализован и проверен вместе с ключом.
+ */
+void shiftText(const char* in, char* out, size_t length, int key, char lang) {
+    if (lang == 'E') {
+        shiftEnglish(in, out, length, key);
+    } else {
+        shiftRussian(in, out, length, key);
+    }
+}
+
+/**
+ * @brief Проверяет ключ и возвращает нормализованный язык
+ */
+char checkKeyAndLanguage(int key, char lang) {
     // Валидация ключа
     if (!isValidKey(key, lang)) {
         throw std::invalid_argument(getKeyRangeError(lang));
     }
     
+    // Нормализуем язык
+    return std::toupper(lang);
+}
+
+/**
+ * @brief Ключ, эквивалентный дешифрованию с ключом key
+ */
+int reverseKey(int key, char lang) {
     // Дешифрование — это шифрование с обратным ключом
-    int alphabetSize = getAlphabetSize(lang);
-    int reverseKey = alphabetSize - key;
+    return getAlphabetSize(lang) - key;
+}
+
+// === Основные функции ===
+
+std::string encryptCaesar(const std::string& text, int key, char lang) {
+    lang = checkKeyAndLanguage(key, lang);
+    
+    std::string result(text.length(), '\0');  // Одна аллокация под результат
+    shiftText(text.data(), &result[0], text.length(), key, lang);
+    
+    return result;
+}
+
+std::string decryptCaesar(const std::string& text, int key, char lang) {
+    lang = checkKeyAndLanguage(key, lang);
     
-    return encryptCaesar(text, reverseKey, lang);
+    std::string result(text.length(), '\0');
+    shiftText(text.data(), &result[0], text.length(), reverseKey(key, lang), lang);
+    
+    return result;
+}
+
+void encryptCaesarInPlace(std::string& text, int key, char lang) {
+    lang = checkKeyAndLanguage(key, lang);
+    shiftText(text.data(), &text[0], text.length(), key, lang);
+}
+
+void decryptCaesarInPlace(std::string& text, int key, char lang) {
+    lang = checkKeyAndLanguage(key, lang);
+    shiftText(text.data(), &text[0], text.length(), reverseKey(key, lang), lang);
+}
+
+size_t encryptCaesar(std::string_view text, char* out, int key, char lang) {
+    lang = checkKeyAndLanguage(key, lang);
+    shiftText(text.data(), out, text.length(), key, lang);
+    return text.length();
+}
+
+size_t decryptCaesar(std::string_view text, char* out, int key, char lang) {
+    lang = checkKeyAndLanguage(key, lang);
+    shiftText(text.data(), out, text.length(), reverseKey(key, lang), lang);
+    return text.length();
 }
 
 bool isValidKey(int key, char lang) {
@@ -148,3 +447,154 @@ std::string getKeyRangeError(char lang) {
     
     return "Ошибка: неподдерживаемый язык";
 }
+
+// === Подбор ключа по частотам букв ===
+
+/**
+ * @brief Частоты букв английского языка, % (a..z)
+ */
+const double ENGLISH_FREQUENCIES[26] = {
+    8.167, 1.492, 2.782, 4.253, 12.702, 2.228, 2.015, 6.094, 6.966, 0.153,
+    0.772, 4.025, 2.406, 6.749, 7.507, 1.929, 0.095, 5.987, 6.327, 9.056,
+    2.758, 0.978, 2.360, 0.150, 1.974, 0.074
+};
+
+/**
+ * @brief Частоты букв русского языка, % (а..я, ё — седьмая)
+ */
+const double RUSSIAN_FREQUENCIES[33] = {
+    8.01, 1.59, 4.54, 1.70, 2.98, 8.45, 0.04, 0.94, 1.65, 7.35, 1.21,
+    3.49, 4.40, 3.21, 6.70, 10.97, 2.81, 4.73, 5.47, 6.26, 2.62, 0.26,
+    0.97, 0.48, 1.44, 0.73, 0.36, 0.04, 1.90, 1.74, 0.32, 0.64, 2.01
+};
+
+/**
+ * @brief Номер буквы в алфавите по байту (латиница) и по CyrillicTable-индексу
+ *
+ * -1 — не буква. Регистр не различается.
+ */
+struct LetterIndexTable {
+    signed char english[256];
+    signed char russian[128];
+    
+    LetterIndexTable() {
+        std::fill(std::begin(english), std::end(english), -1);
+        std::fill(std::begin(russian), std::end(russian), -1);
+        for (size_t pos = 0; pos < ENGLISH_LOWER.length(); pos++) {
+            english[static_cast<unsigned char>(ENGLISH_LOWER[pos])] = static_cast<signed char>(pos);
+            english[static_cast<unsigned char>(ENGLISH_UPPER[pos])] = static_cast<signed char>(pos);
+        }
+        for (const std::string* alphabet : {&RUSSIAN_LOWER, &RUSSIAN_UPPER}) {
+            for (size_t pos = 0; pos < alphabet->length() / 2; pos++) {
+                unsigned idx = cyrillicIndex((*alphabet)[pos * 2], (*alphabet)[pos * 2 + 1]);
+                russian[idx] = static_cast<signed char>(pos);
+            }
+        }
+    }
+};
+
+const LetterIndexTable& getLetterIndexTable() {
+    static const LetterIndexTable table;
+    return table;
+}
+
+LetterHistogram buildLetterHistogram(std::string_view text) {
+    // Проход только считает байты и двухбайтовые коды кириллицы;
+    // в буквы они сворачиваются после, по 256 + 128 счётчикам
+    uint64_t bytes[256] = {};
+    uint64_t cyrillic[128] = {};
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(text.data());
+    size_t length = text.length();
+    
+    size_t i = 0;
+    while (i < length) {
+        unsigned char lead = src[i];
+        if ((lead & 0xFE) == 0xD0 && i + 1 < length && (src[i + 1] & 0xC0) == 0x80) {
+            cyrillic[cyrillicIndex(lead, src[i + 1])]++;
+            i += 2;
+        } else {
+            bytes[lead]++;
+            i++;
+        }
+    }
+    
+    const LetterIndexTable& table = getLetterIndexTable();
+    LetterHistogram histogram;
+    for (int b = 0; b < 256; b++) {
+        if (table.english[b] >= 0) {
+            histogram.english[table.english[b]] += bytes[b];
+            histogram.englishLetters += bytes[b];
+        }
+    }
+    for (int idx = 0; idx < 128; idx++) {
+        if (table.russian[idx] >= 0) {
+            histogram.russian[table.russian[idx]] += cyrillic[idx];
+            histogram.russianLetters += cyrillic[idx];
+        }
+    }
+    return histogram;
+}
+
+std::vector<double> scoreCaesarKeys(const LetterHistogram& histogram, char lang) {
+    lang = std::toupper(lang);
+    if (lang != 'E' && lang != 'R') {
+        throw std::invalid_argument(getKeyRangeError(lang));
+    }
+    
+    const uint64_t* counts = lang == 'E' ? histogram.english : histogram.russian;
+    const double* frequencies = lang == 'E' ? ENGLISH_FREQUENCIES : RUSSIAN_FREQUENCIES;
+    int size = getAlphabetSize(lang);
+    double letters = static_cast<double>(lang == 'E' ? histogram.englishLetters : histogram.russianLetters);
+    double frequencySum = std::accumulate(frequencies, frequencies + size, 0.0);
+    
+    std::vector<double> scores(size, 0.0);
+    if (letters == 0) {
+        return scores;
+    }
+    
+    // Ожидаемые числа букв и гистограмма, повторённая дважды: сдвиг на
+    // ключ — просто смещение начала, без деления по модулю
+    double expected[33], inverse[33], observed[66];
+    for (int j = 0; j < size; j++) {
+        expected[j] = letters * frequencies[j] / frequencySum;
+        inverse[j] = 1.0 / expected[j];
+        observed[j] = observed[j + size] = static_cast<double>(counts[j]);
+    }
+    for (int key = 0; key < size; key++) {
+        double chiSquared = 0;
+        for (int j = 0; j < size; j++) {
+            double diff = observed[j + key] - expected[j];
+            chiSquared += diff * diff * inverse[j];
+        }
+        scores[key] = chiSquared;
+    }
+    return scores;
+}
+
+CaesarCrackResult findCaesarKey(std::string_view text, char lang) {
+    LetterHistogram histogram = buildLetterHistogram(text);
+    
+    CaesarCrackResult result;
+    if (lang == 0) {
+        result.lang = histogram.russianLetters > histogram.englishLetters ? 'R' : 'E';
+    } else {
+        result.lang = std::toupper(lang);
+    }
+    
+    std::vector<double> scores = scoreCaesarKeys(histogram, result.lang);
+    result.key = static_cast<int>(std::min_element(scores.begin(), scores.end()) - scores.begin());
+    result.chiSquared = scores[result.key];
+    result.letters = result.lang == 'E' ? histogram.englishLetters : histogram.russianLetters;
+    return result;
+}
+
+CaesarCrackResult crackCaesar(std::string_view text, char lang) {
+    CaesarCrackResult result = findCaesarKey(text, lang);
+    if (result.key == 0) {
+        result.text.assign(text);
+        return result;
+    }
+    result.text.assign(text.length(), '\0');
+    shiftText(text.data(), &result.text[0], text.length(), reverseKey(result.key, result.lang), result.lang);
+    return result;
+}
@@ -1,42 +1,356 @@
 #include "json_parser.h"
 #include <fstream>
-#include <sstream>
 #include <cctype>
 #include <stdexcept>
+#include <cstdio>
+#include <filesystem>
+#include <new>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define JSON_HAVE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// SSE2 есть у любого x86-64; на других платформах поиск идёт по 8 байтов (SWAR)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_HAVE_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 // === Реализация JsonValue ===
 
+JsonValue JsonValue::borrow(std::string_view s) {
+    JsonValue value;
+    value.data = s;
+    return value;
+}
+
+JsonType JsonValue::type() const {
+    switch (data.index()) {
+        case 1: return JsonType::Boolean;
+        case 2: return JsonType::Number;
+        case 3:
+        case 4: return JsonType::String;
+        case 5: return JsonType::Array;
+        case 6: return JsonType::Object;
+        default: return JsonType::Null;
+    }
+}
+
+bool JsonValue::isBorrowed() const {
+    return std::holds_alternative<std::string_view>(data);
+}
+
 std::string JsonValue::asString() const {
-    if (type == JsonType::String) return stringValue;
-    if (type == JsonType::Number) return std::to_string(numberValue);
-    if (type == JsonType::Boolean) return boolValue ? "true" : "false";
-    return "";
+    if (const auto* n = std::get_if<double>(&data)) return std::to_string(*n);
+    if (const auto* b = std::get_if<bool>(&data)) return *b ? "true" : "false";
+    return std::string(asStringView());
 }
 
 double JsonValue::asNumber() const {
-    if (type == JsonType::Number) return numberValue;
+    if (const auto* n = std::get_if<double>(&data)) return *n;
     try {
-        return std::stod(stringValue);
+        return std::stod(std::string(asStringView()));
     } catch (...) {
         return 0.0;
     }
 }
 
 bool JsonValue::asBoolean() const {
-    return type == JsonType::Boolean ? boolValue : false;
+    const auto* b = std::get_if<bool>(&data);
+    return b ? *b : false;
+}
+
+std::string_view JsonValue::asStringView() const {
+    if (const auto* s = std::get_if<std::string>(&data)) return *s;
+    if (const auto* v = std::get_if<std::string_view>(&data)) return *v;
+    return std::string_view();
+}
+
+std::string& JsonValue::ownedString() {
+    if (auto* s = std::get_if<std::string>(&data)) return *s;
+    data = std::string(asStringView());
+    return std::get<std::string>(data);
+}
+
+JsonArray& JsonValue::asArray() {
+    if (auto* a = std::get_if<JsonArray>(&data)) return *a;
+    throw std::runtime_error("JSON значение не является массивом");
+}
+
+const JsonArray& JsonValue::asArray() const {
+    if (const auto* a = std::get_if<JsonArray>(&data)) return *a;
+    throw std::runtime_error("JSON значение не является массивом");
+}
+
+JsonObject& JsonValue::asObject() {
+    if (auto* o = std::get_if<JsonObject>(&data)) return *o;
+    throw std::runtime_error("JSON значение не является объектом");
+}
+
+const JsonObject& JsonValue::asObject() const {
+    if (const auto* o = std::get_if<JsonObject>(&data)) return *o;
+    throw std::runtime_error("JSON значение не является объектом");
+}
+
+// === Реализация JsonObject ===
+
+namespace {
+
+/**
+ * @brief Первая пара с ключом не меньше key (двоичный поиск)
+ */
+template <typename Iterator>
+Iterator lowerBoundKey(Iterator first, Iterator last, std::string_view key) {
+    return std::lower_bound(first, last, key,
+                            [](const JsonObject::value_type& item, std::string_view k) {
+                                return std::string_view(item.first) < k;
+                            });
+}
+
+} // namespace
+
+JsonObject::iterator JsonObject::begin() { return items.begin(); }
+JsonObject::iterator JsonObject::end() { return items.end(); }
+JsonObject::const_iterator JsonObject::begin() const { return items.begin(); }
+JsonObject::const_iterator JsonObject::end() const { return items.end(); }
+size_t JsonObject::size() const { return items.size(); }
+bool JsonObject::empty() const { return items.empty(); }
+void JsonObject::reserve(size_t count) { items.reserve(count); }
+
+JsonObject::iterator JsonObject::find(std::string_view key) {
+    auto it = lowerBoundKey(items.begin(), items.end(), key);
+    return (it != items.end() && it->first == key) ? it : items.end();
+}
+
+JsonObject::const_iterator JsonObject::find(std::string_view key) const {
+    auto it = lowerBoundKey(items.begin(), items.end(), key);
+    return (it != items.end() && it->first == key) ? it : items.end();
+}
+
+size_t JsonObject::count(std::string_view key) const {
+    return find(key) != end() ? 1 : 0;
+}
+
+JsonValue& JsonObject::at(std::string_view key) {
+    auto it = find(key);
+    if (it == items.end()) {
+        throw std::out_of_range("Нет ключа в объекте: " + std::string(key));
+    }
+    return it->second;
+}
+
+const JsonValue& JsonObject::at(std::string_view key) const {
+    auto it = find(key);
+    if (it == items.end()) {
+        throw std::out_of_range("Нет ключа в объекте: " + std::string(key));
+    }
+    return it->second;
+}
+
+JsonValue& JsonObject::operator[](std::string_view key) {
+    auto it = lowerBoundKey(items.begin(), items.end(), key);
+    if (it == items.end() || it->first != key) {
+        // Ключ создаётся в ресурсе памяти самого объекта
+        it = items.emplace(it, std::piecewise_construct,
+                           std::forward_as_tuple(key), std::forward_as_tuple());
+    }
+    return it->second;
+}
+
+std::pair<JsonObject::iterator, bool> JsonObject::insert_or_assign(std::string_view key,
+                                                                  JsonValue value) {
+    auto it = lowerBoundKey(items.begin(), items.end(), key);
+    if (it != items.end() && it->first == key) {
+        it->second = std::move(value);
+        return {it, false};
+    }
+    it = items.emplace(it, std::piecewise_construct,
+                       std::forward_as_tuple(key), std::forward_as_tuple(std::move(value)));
+    return {it, true};
 }
 
+size_t JsonObject::erase(std::string_view key) {
+    auto it = find(key);
+    if (it == items.end()) return 0;
+    items.erase(it);
+    return 1;
+}
+
+// === Поиск символов блоками ===
+
+namespace {
+
+// Пробельные символы по грамматике JSON
+inline bool isJsonWhitespace(char ch) {
+    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r';
+}
+
+#ifdef JSON_HAVE_SSE2
+inline int lowestSetBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+/**
+ * @brief Первая кавычка или '\\' в [p, end); end, если их нет
+ *
+ * С SSE2 проверяется 16 байтов за сравнение, без него — 8 (SWAR);
+ * остаток короче блока и найденное SWAR-слово — побайтово.
+ */
+inline const char* findQuoteOrBackslash(const char* p, const char* end) {
+#ifdef JSON_HAVE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, slash))));
+        if (mask != 0) return p + lowestSetBit(mask);
+        p += 16;
+    }
+#else
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGH = 0x8080808080808080ULL;
+    while (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        uint64_t quote = word ^ (ONES * '"');
+        uint64_t slash = word ^ (ONES * '\\');
+        if ((((quote - ONES) & ~quote) | ((slash - ONES) & ~slash)) & HIGH) break;
+        p += 8;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') p++;
+    return p;
+}
+
+/**
+ * @brief Первая кавычка или скобка в [p, end); end, если их нет
+ *
+ * '[' и ']' отличаются от '{' и '}' только битом 0x20, поэтому после
+ * OR с 0x20 хватает трёх сравнений на блок.
+ */
+inline const char* findJsonStructural(const char* p, const char* end) {
+#ifdef JSON_HAVE_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i folded = _mm_or_si128(block, caseBit);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(block, quote),
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)))));
+        if (mask != 0) return p + lowestSetBit(mask);
+        p += 16;
+    }
+#else
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGH = 0x8080808080808080ULL;
+    while (end - p >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        uint64_t folded = word | (ONES * 0x20);
+        uint64_t quote = word ^ (ONES * '"');
+        uint64_t open = folded ^ (ONES * '{');
+        uint64_t close = folded ^ (ONES * '}');
+        if ((((quote - ONES) & ~quote) | ((open - ONES) & ~open) | ((close - ONES) & ~close)) & HIGH) break;
+        p += 8;
+    }
+#endif
+    while (p < end && *p != '"' && (*p | 0x20) != '{' && (*p | 0x20) != '}') p++;
+    return p;
+}
+
+/**
+ * @brief Первый непробельный байт в [p, end); end, если его нет
+ *
+ * Между лексемами обычно ноль или один пробел — это проверяется до
+ * блочного поиска; блоком пропускаются отступы форматированного текста.
+ */
+inline const char* skipJsonSpaces(const char* p, const char* end) {
+    if (p == end || !isJsonWhitespace(*p)) return p;
+#ifdef JSON_HAVE_SSE2
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i spaces = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\t')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\r'))));
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(spaces)) & 0xFFFFu;
+        if (mask != 0) return p + lowestSetBit(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && isJsonWhitespace(*p)) p++;
+    return p;
+}
+
+/**
+ * @brief Пропускает число по грамматике JSON
+ *
+ * -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)? — общая для парсера и
+ * структурной проверки, чтобы они принимали одни и те же числа.
+ *
+ * @return false, если в pos нет числа (pos тогда не меняется)
+ */
+bool scanJsonNumber(std::string_view text, size_t& pos) {
+    auto isDigit = [&text](size_t i) { return i < text.size() && text[i] >= '0' && text[i] <= '9'; };
+    size_t i = pos;
+    if (i < text.size() && text[i] == '-') i++;
+    if (!isDigit(i)) return false;
+    if (text[i] == '0') {
+        i++;
+    } else {
+        while (isDigit(i)) i++;
+    }
+    if (i < text.size() && text[i] == '.') {
+        if (!isDigit(++i)) return false;
+        while (isDigit(i)) i++;
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+        i++;
+        if (i < text.size() && (text[i] == '+' || text[i] == '-')) i++;
+        if (!isDigit(i)) return false;
+        while (isDigit(i)) i++;
+    }
+    pos = i;
+    return true;
+}
+
+} // namespace
+
 // === Парсинг JSON ===
 
 class JsonParser {
 private:
-    std::string input;
+    std::string_view input;
     size_t pos;
+    bool borrowStrings;
+    std::pmr::memory_resource* arena;   // nullptr — обычная куча
+    std::string scratch;                // Ключ с экранированием после разбора
     
     void skipWhitespace() {
-        while (pos < input.length() && std::isspace(input[pos])) {
-            pos++;
-        }
+        pos = static_cast<size_t>(skipJsonSpaces(input.data() + pos, input.data() + input.size()) -
+                                  input.data());
     }
     
     char peek() {
@@ -53,24 +367,28 @@ private:
     std::string parseString() {
         if (consume() != '"') throw std::runtime_error("Ожидается кавычка");
         
+        // Участки между escape-последовательностями копируются целиком
         std::string result;
-        while (pos < input.length() && input[pos] != '"') {
-            if (input[pos] == '\\') {
-                pos++;
-                if (pos >= input.length()) throw std::runtime_error("Неполное экранирование");
-                
-                switch (input[pos]) {
-                    case '"': result += '"'; break;
-                    case '\\': result += '\\'; break;
-                    case 'n': result += '\n'; break;
-                    case 't': result += '\t'; break;
-                    case 'r': result += '\r'; break;
-                    default: result += input[pos];
-                }
-                pos++;
-            } else {
-                result += input[pos++];
+        const char* end = input.data() + input.size();
+        while (true) {
+            const char* run = input.data() + pos;
+            const char* stop = findQuoteOrBackslash(run, end);
+            result.append(run, stop);
+            pos = static_cast<size_t>(stop - input.data());
+            if (stop == end || *stop == '"') break;
+            
+            pos++;
+            if (pos >= input.length()) throw std::runtime_error("Неполное экранирование");
+            
+            switch (input[pos]) {
+                case '"': result += '"'; break;
+                case '\\': result += '\\'; break;
+                case 'n': result += '\n'; break;
+                case 't': result += '\t'; break;
+                case 'r': result += '\r'; break;
+                default: result += input[pos];
             }
+            pos++;
         }
         
         if (pos >= input.length()) throw std::runtime_error("Незакрытая строка");
@@ -78,38 +396,79 @@ private:
         return result;
     }
     
+    /**
+     * @brief Строка без экранирования как срез входа; иначе false
+     *
+     * pos должен указывать на открывающую кавычку.
+     */
+    bool tryRawString(std::string_view& raw) {
+        size_t start = pos + 1;
+        size_t end = static_cast<size_t>(
+            findQuoteOrBackslash(input.data() + start, input.data() + input.size()) - input.data());
+        if (end < input.length() && input[end] == '"') {
+            raw = input.substr(start, end - start);
+            pos = end + 1;
+            return true;
+        }
+        return false;
+    }
+    
+    /**
+     * @brief Копирует байты строки в арену и возвращает заимствующее значение
+     */
+    JsonValue arenaString(std::string_view text) {
+        char* bytes = static_cast<char*>(arena->allocate(text.size() ? text.size() : 1, 1));
+        text.copy(bytes, text.size());
+        return JsonValue::borrow(std::string_view(bytes, text.size()));
+    }
+    
+    JsonValue parseStringValue() {
+        std::string_view raw;
+        if ((borrowStrings || arena) && tryRawString(raw)) {
+            // Строку без экранирования можно не копировать (или скопировать в арену)
+            return arena ? arenaString(raw) : JsonValue::borrow(raw);
+        }
+        if (arena) {
+            return arenaString(parseString());
+        }
+        return JsonValue(parseString());
+    }
+    
+    std::string_view parseKey() {
+        skipWhitespace();
+        std::string_view raw;
+        if (pos < input.length() && input[pos] == '"' && tryRawString(raw)) {
+            return raw;
+        }
+        scratch = parseString();
+        return scratch;
+    }
+    
+    std::pmr::memory_resource* resource() {
+        return arena ? arena : std::pmr::get_default_resource();
+    }
+    
     JsonValue parseNumber() {
         size_t start = pos;
-        
-        if (input[pos] == '-') pos++;
-        
-        while (pos < input.length() && std::isdigit(input[pos])) pos++;
-        
-        if (pos < input.length() && input[pos] == '.') {
-            pos++;
-            while (pos < input.length() && std::isdigit(input[pos])) pos++;
-        }
-        
-        std::string numStr = input.substr(start, pos - start);
-        try {
-            return JsonValue(std::stod(numStr));
-        } catch (...) {
-            throw std::runtime_error("Невалидное число: " + numStr);
+        double value = 0;
+        if (!scanJsonNumber(input, pos) ||
+            std::from_chars(input.data() + start, input.data() + pos, value).ec != std::errc()) {
+            throw std::runtime_error("Невалидное число на позиции " + std::to_string(start));
         }
+        return JsonValue(value);
     }
     
     JsonValue parseArray() {
         consume();  // '['
-        JsonValue arr;
-        arr.type = JsonType::Array;
+        JsonArray arr(resource());
         
         if (peek() == ']') {
             consume();
-            return arr;
+            return JsonValue(std::move(arr));
         }
         
         while (true) {
-            arr.arrayValue.push_back(parseValue());
+            arr.push_back(parseValue());
             
             if (peek() == ']') {
                 consume();
@@ -121,27 +480,33 @@ private:
             }
         }
         
-        return arr;
+        return JsonValue(std::move(arr));
     }
     
     JsonValue parseObject() {
         consume();  // '{'
-        JsonValue obj;
-        obj.type = JsonType::Object;
+        JsonObject obj(resource());
         
         if (peek() == '}') {
             consume();
-            return obj;
+            return JsonValue(std::move(obj));
         }
         
         while (true) {
-            std::string key = parseString();
+            // Ключ без экранирования указывает во входной текст; ключ из
+            // scratch копируется до разбора значения, которое его перезапишет
+            std::string_view key = parseKey();
+            std::string escapedKey;
+            if (key.data() == scratch.data()) {
+                escapedKey.assign(key);
+                key = escapedKey;
+            }
             
             if (consume() != ':') {
                 throw std::runtime_error("Ожидается ':' после ключа объекта");
             }
             
-            obj.objectValue[key] = parseValue();
+            obj.insert_or_assign(key, parseValue());
             
             if (peek() == '}') {
                 consume();
@@ -153,11 +518,12 @@ private:
             }
         }
         
-        return obj;
+        return JsonValue(std::move(obj));
     }
     
 public:
-    JsonParser(const std::string& json) : input(json), pos(0) {}
+    JsonParser(std::string_view json, bool borrow, std::pmr::memory_resource* arenaResource = nullptr)
+        : input(json), pos(0), borrowStrings(borrow), arena(arenaResource) {}
     
     JsonValue parse() {
         JsonValue result = parseValue();
@@ -177,7 +543,7 @@ public:
         
         char ch = input[pos];
         
-        if (ch == '"') return JsonValue(parseString());
+        if (ch == '"') return parseStringValue();
         if (ch == '[') return parseArray();
         if (ch == '{') return parseObject();
         if (ch == 't' || ch == 'f') {
@@ -208,104 +574,434 @@ public:
 
 // === Публичные функции ===
 
-JsonValue parseJson(const std::string& jsonStr) {
+JsonValue parseJson(std::string_view jsonStr, bool borrowStrings) {
     try {
-        JsonParser parser(jsonStr);
+        JsonParser parser(jsonStr, borrowStrings);
         return parser.parse();
     } catch (const std::exception& e) {
         throw std::runtime_error(std::string("Ошибка парсинга JSON: ") + e.what());
     }
 }
 
-std::string jsonToString(const JsonValue& value, bool pretty) {
-    std::ostringstream oss;
+namespace {
+
+// Символы, которые экранируются при выводе строки
+constexpr std::array<bool, 256> makeEscapeTable() {
+    std::array<bool, 256> table{};
+    table[static_cast<unsigned char>('"')] = true;
+    table[static_cast<unsigned char>('\\')] = true;
+    table[static_cast<unsigned char>('\n')] = true;
+    table[static_cast<unsigned char>('\t')] = true;
+    table[static_cast<unsigned char>('\r')] = true;
+    return table;
+}
+
+constexpr std::array<bool, 256> ESCAPE_TABLE = makeEscapeTable();
+
+/**
+ * @brief Есть ли среди 8 байтов '"', '\\' или управляющий символ
+ *
+ * Проверка всего слова сразу (SWAR); ложные срабатывания возможны,
+ * пропусков нет — найденное слово дальше разбирается побайтово.
+ */
+inline bool mayNeedEscape(const char* p) {
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGH = 0x8080808080808080ULL;
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    uint64_t quote = word ^ (ONES * '"');
+    uint64_t slash = word ^ (ONES * '\\');
+    uint64_t found = ((word - ONES * 0x20) & ~word) |     // байт < 0x20
+                     ((quote - ONES) & ~quote) |
+                     ((slash - ONES) & ~slash);
+    return (found & HIGH) != 0;
+}
+
+} // namespace
+
+void appendJsonString(std::string& out, std::string_view s) {
+    out.push_back('"');
+    // Участки без спецсимволов копируются целиком
+    size_t runStart = 0;
+    size_t i = 0;
+    while (i < s.size()) {
+        // Слова по 8 байтов без кандидатов на экранирование пропускаются сразу
+        if (i + 8 <= s.size() && !mayNeedEscape(s.data() + i)) {
+            i += 8;
+            continue;
+        }
+        unsigned char ch = static_cast<unsigned char>(s[i]);
+        if (!ESCAPE_TABLE[ch]) {
+            i++;
+            continue;
+        }
+        out.append(s.data() + runStart, i - runStart);
+        out.push_back('\\');
+        switch (ch) {
+            case '\n': out.push_back('n'); break;
+            case '\t': out.push_back('t'); break;
+            case '\r': out.push_back('r'); break;
+            default:   out.push_back(static_cast<char>(ch)); break;  // '"' и '\\'
+        }
+        runStart = ++i;
+    }
+    out.append(s.data() + runStart, s.size() - runStart);
+    out.push_back('"');
+}
+
+namespace {
+
+// Порог сброса буфера в поток
+constexpr size_t FLUSH_THRESHOLD = 64 * 1024;
+
+/**
+ * @brief Сериализатор: дописывает JSON в строку-буфер
+ *
+ * Если задан поток, накопленный буфер сбрасывается в него частями
+ * по FLUSH_THRESHOLD, и большой документ не собирается в памяти целиком.
+ */
+class JsonSerializer {
+private:
+    std::string& out;
+    bool pretty;
+    std::ostream* sink;
     
-    std::function<void(const JsonValue&, int)> stringify = 
-        [&](const JsonValue& val, int indent) {
-        std::string indentStr(indent * 2, ' ');
-        std::string nextIndentStr((indent + 1) * 2, ' ');
-        
-        switch (val.type) {
+    void newline(int indent) {
+        out.push_back('\n');
+        out.append(static_cast<size_t>(indent) * 2, ' ');
+    }
+    
+    void maybeFlush() {
+        if (sink && out.size() >= FLUSH_THRESHOLD) flush();
+    }
+    
+    void writeString(std::string_view s) {
+        appendJsonString(out, s);
+    }
+    
+    void writeNumber(double n) {
+        // Тот же вид, что у operator<< по умолчанию (%g, 6 значащих цифр)
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), n,
+                                    std::chars_format::general, 6);
+        out.append(buffer, result.ptr);
+    }
+    
+public:
+    JsonSerializer(std::string& buffer, bool prettyOutput, std::ostream* output = nullptr)
+        : out(buffer), pretty(prettyOutput), sink(output) {}
+    
+    void write(const JsonValue& value, int indent) {
+        switch (value.type()) {
             case JsonType::Null:
-                oss << "null";
+                out.append("null");
                 break;
             case JsonType::Boolean:
-                oss << (val.boolValue ? "true" : "false");
+                out.append(value.asBoolean() ? "true" : "false");
                 break;
             case JsonType::Number:
-                oss << val.numberValue;
+                writeNumber(value.asNumber());
                 break;
-            case JsonType::String: {
-                oss << '"';
-                for (char ch : val.stringValue) {
-                    if (ch == '"') oss << "\\\"";
-                    else if (ch == '\\') oss << "\\\\";
-                    else if (ch == '\n') oss << "\\n";
-                    else if (ch == '\t') oss << "\\t";
-                    else if (ch == '\r') oss << "\\r";
-                    else oss << ch;
-                }
-                oss << '"';
+            case JsonType::String:
+                writeString(value.asStringView());
                 break;
-            }
-            case JsonType::Array:
-                oss << "[";
-                for (size_t i = 0; i < val.arrayValue.size(); i++) {
-                    if (pretty && i > 0) oss << "\n" << nextIndentStr;
-                    else if (i > 0) oss << ", ";
-                    stringify(val.arrayValue[i], indent + 1);
-                    if (pretty && i < val.arrayValue.size() - 1) oss << ",";
+            case JsonType::Array: {
+                // Первый элемент идёт сразу за '[', следующие — с новой строки
+                const JsonArray& arr = value.asArray();
+                out.push_back('[');
+                for (size_t i = 0; i < arr.size(); i++) {
+                    if (i > 0) {
+                        if (pretty) {
+                            out.push_back(',');
+                            newline(indent + 1);
+                        } else {
+                            out.append(", ");
+                        }
+                    }
+                    write(arr[i], indent + 1);
+                    maybeFlush();
                 }
-                if (pretty && !val.arrayValue.empty()) oss << "\n" << indentStr;
-                oss << "]";
+                if (pretty && !arr.empty()) newline(indent);
+                out.push_back(']');
                 break;
-            case JsonType::Object: {
-                oss << "{";
-                size_t i = 0;
-                for (const auto& [key, obj_val] : val.objectValue) {
-                    if (pretty) oss << "\n" << nextIndentStr;
-                    else if (i > 0) oss << ", ";
-                    oss << "\"" << key << "\": ";
-                    stringify(obj_val, indent + 1);
-                    if (pretty && i < val.objectValue.size() - 1) oss << ",";
-                    i++;
-                }
-                if (pretty && !val.objectValue.empty()) oss << "\n" << indentStr;
-                oss << "}";
+            }
+            case JsonType::Object:
+                writeObject(value.asObject(), indent);
                 break;
+        }
+    }
+    
+    void writeObject(const JsonObject& obj, int indent) {
+        out.push_back('{');
+        bool first = true;
+        for (const auto& [key, item] : obj) {
+            if (!first) out.push_back(',');
+            if (pretty) newline(indent + 1);
+            else if (!first) out.push_back(' ');
+            writeString(key);
+            out.append(": ");
+            write(item, indent + 1);
+            first = false;
+        }
+        if (pretty && !obj.empty()) newline(indent);
+        out.push_back('}');
+    }
+    
+    /**
+     * @brief Объект по требованию: поля по порядку ключей, неизменённые — как есть
+     *
+     * fields — буфер писателя для сырых полей, чтобы не выделять его
+     * на каждый объект.
+     */
+    void writeLazyObject(const JsonLazyObject& object, int indent,
+                         std::vector<std::pair<std::string_view, std::string_view>>& fields) {
+        fields.clear();
+        JsonFieldCursor cursor(object.text(), true);
+        std::string_view key, raw;
+        while (cursor.next(key, raw)) {
+            fields.emplace_back(key, raw);
+        }
+        // Порядок ключей как у JsonObject; из повторов остаётся последний,
+        // как в parseJson. Полей единицы: сортировка вставками устойчива и
+        // не выделяет временный буфер, как std::stable_sort
+        for (size_t i = 1; i < fields.size(); i++) {
+            for (size_t j = i; j > 0 && fields[j].first < fields[j - 1].first; j--) {
+                std::swap(fields[j], fields[j - 1]);
+            }
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < fields.size(); i++) {
+            if (i + 1 < fields.size() && fields[i + 1].first == fields[i].first) continue;
+            fields[kept++] = fields[i];
+        }
+        fields.resize(kept);
+        
+        // Слияние с изменёнными полями, которые уже отсортированы
+        const JsonObject& changes = object.changedFields();
+        auto change = changes.begin();
+        size_t i = 0;
+        bool first = true;
+        out.push_back('{');
+        while (i < fields.size() || change != changes.end()) {
+            if (!first) out.push_back(',');
+            if (pretty) newline(indent + 1);
+            else if (!first) out.push_back(' ');
+            first = false;
+            
+            if (change != changes.end() &&
+                (i == fields.size() || std::string_view(change->first) <= fields[i].first)) {
+                if (i < fields.size() && fields[i].first == change->first) i++;  // Поле заменено
+                writeString(change->first);
+                out.append(": ");
+                write(change->second, indent + 1);
+                ++change;
+            } else {
+                out.push_back('"');
+                out.append(fields[i].first);
+                out.append("\": ");
+                out.append(fields[i].second);
+                i++;
             }
         }
-    };
+        if (pretty && !first) newline(indent);
+        out.push_back('}');
+    }
     
-    stringify(value, 0);
-    return oss.str();
+    // Сбрасывает накопленное в поток (если он задан)
+    void flush() {
+        if (!sink) return;
+        sink->write(out.data(), static_cast<std::streamsize>(out.size()));
+        out.clear();
+    }
+};
+
+} // namespace
+
+std::string jsonToString(const JsonValue& value, bool pretty) {
+    std::string result;
+    JsonSerializer(result, pretty).write(value, 0);
+    return result;
 }
 
-JsonValue loadJsonFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Не удалось открыть файл: " + filename);
+// === Отображение файлов в память ===
+
+/**
+ * @brief Файл, отображённый в память только для чтения
+ *
+ * Там, где mmap недоступен (или для пустого файла), содержимое читается
+ * в обычный буфер.
+ */
+class MappedFile {
+private:
+    const char* mappedData;
+    size_t mappedSize;
+    std::string fallbackBuffer;
+    
+public:
+    explicit MappedFile(const std::string& filename) : mappedData(nullptr), mappedSize(0) {
+#ifdef JSON_HAVE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Не удалось открыть файл: " + filename);
+        }
+        
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size),
+                                  PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                ::madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+                mappedData = static_cast<const char*>(mapped);
+                mappedSize = static_cast<size_t>(info.st_size);
+            }
+        }
+        ::close(fd);
+        if (mappedData) return;
+#endif
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось открыть файл: " + filename);
+        }
+        fallbackBuffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    
+    // Поток (например, stdin) не отображается — читается в буфер целиком
+    explicit MappedFile(std::istream& input) : mappedData(nullptr), mappedSize(0) {
+        char block[64 * 1024];
+        while (input.read(block, sizeof(block)) || input.gcount() > 0) {
+            fallbackBuffer.append(block, static_cast<size_t>(input.gcount()));
+        }
+        if (input.bad()) {
+            throw std::runtime_error("Ошибка чтения входного потока");
+        }
+    }
+    
+    ~MappedFile() {
+#ifdef JSON_HAVE_MMAP
+        if (mappedData) {
+            ::munmap(const_cast<char*>(mappedData), mappedSize);
+        }
+#endif
     }
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
     
-    return parseJson(buffer.str());
+    std::string_view view() const {
+        return mappedData ? std::string_view(mappedData, mappedSize)
+                          : std::string_view(fallbackBuffer);
+    }
+};
+
+JsonDocument::JsonDocument() = default;
+
+JsonDocument::JsonDocument(const std::string& filename, JsonParseMode mode)
+    : file(new MappedFile(filename)) {
+    if (mode == JsonParseMode::Full) {
+        rootValue = parseJson(file->view(), true);
+    }
+}
+
+JsonDocument::JsonDocument(std::istream& input, JsonParseMode mode)
+    : file(new MappedFile(input)) {
+    if (mode == JsonParseMode::Full) {
+        rootValue = parseJson(file->view(), true);
+    }
+}
+
+std::string_view JsonDocument::text() const {
+    return file ? file->view() : std::string_view();
+}
+
+size_t JsonDocument::size() const {
+    return file ? file->view().size() : 0;
+}
+
+JsonDocument::JsonDocument(JsonDocument&& other) noexcept = default;
+JsonDocument& JsonDocument::operator=(JsonDocument&& other) noexcept = default;
+JsonDocument::~JsonDocument() = default;
+
+JsonValue& JsonDocument::root() {
+    return rootValue;
+}
+
+const JsonValue& JsonDocument::root() const {
+    return rootValue;
+}
+
+JsonArenaDocument::JsonArenaDocument(std::string_view jsonStr)
+    : arena(new std::pmr::monotonic_buffer_resource(jsonStr.size() + 1024)), rootValue(nullptr) {
+    JsonValue parsed;
+    try {
+        JsonParser parser(jsonStr, false, arena.get());
+        parsed = parser.parse();
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string("Ошибка парсинга JSON: ") + e.what());
+    }
+    // Корень тоже размещается в арене; перемещение сохраняет аллокаторы контейнеров
+    void* slot = arena->allocate(sizeof(JsonValue), alignof(JsonValue));
+    rootValue = new (slot) JsonValue(std::move(parsed));
+}
+
+JsonArenaDocument::JsonArenaDocument(JsonArenaDocument&& other) noexcept
+    : arena(std::move(other.arena)), rootValue(other.rootValue) {
+    other.rootValue = nullptr;
+}
+
+JsonArenaDocument& JsonArenaDocument::operator=(JsonArenaDocument&& other) noexcept {
+    if (this != &other) {
+        arena = std::move(other.arena);
+        rootValue = other.rootValue;
+        other.rootValue = nullptr;
+    }
+    return *this;
+}
+
+JsonArenaDocument::~JsonArenaDocument() {
+    // Деструкторы узлов не вызываются: вся их память принадлежит арене,
+    // которая освобождается одним вызовом release() в своём деструкторе
+}
+
+const JsonValue& JsonArenaDocument::root() const {
+    static const JsonValue nullValue;
+    return rootValue ? *rootValue : nullValue;
+}
+
+JsonValue loadJsonFile(const std::string& filename) {
+    MappedFile file(filename);
+    return parseJson(file.view());
 }
 
 void saveJsonFile(const std::string& filename, const JsonValue& value, bool pretty) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        throw std::runtime_error("Не удалось создать файл: " + filename);
+    // Пишем рядом и подменяем целевой файл, чтобы не обрезать файл,
+    // который может быть отображён в память JsonDocument
+    std::string tempName = filename + ".tmp";
+    {
+        std::ofstream file(tempName, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Не удалось создать файл: " + filename);
+        }
+        
+        // Документ пишется в файл частями, а не собирается в одну строку
+        std::string buffer;
+        buffer.reserve(FLUSH_THRESHOLD * 2);
+        JsonSerializer serializer(buffer, pretty, &file);
+        serializer.write(value, 0);
+        serializer.flush();
+        if (!file) {
+            throw std::runtime_error("Ошибка записи в файл: " + filename);
+        }
     }
     
-    file << jsonToString(value, pretty);
-    if (!file) {
+    std::error_code error;
+    std::filesystem::rename(tempName, filename, error);
+    if (error) {
+        std::filesystem::remove(tempName, error);
         throw std::runtime_error("Ошибка записи в файл: " + filename);
     }
 }
 
-bool isValidJson(const std::string& jsonStr, std::string& errorMsg) {
+bool isValidJson(std::string_view jsonStr, std::string& errorMsg) {
     try {
         parseJson(jsonStr);
         return true;
@@ -314,3 +1010,462 @@ bool isValidJson(const std::string& jsonStr, std::string& errorMsg) {
         return false;
     }
 }
+
+// === Структурная проверка ===
+// Значения проверяются по грамматике JSON без построения дерева: текст,
+// прошедший проверку, может уйти в выход как есть (JsonLazyObject)
+
+namespace {
+
+size_t skipJsonWhitespace(std::string_view text, size_t pos) {
+    return static_cast<size_t>(skipJsonSpaces(text.data() + pos, text.data() + text.size()) - text.data());
+}
+
+/**
+ * @brief Позиция за закрывающей кавычкой строки, открытой в pos
+ *
+ * Кавычка ищется memchr; она закрывает строку, если перед ней чётное
+ * число '\\'.
+ */
+size_t skipJsonString(std::string_view text, size_t pos) {
+    size_t from = pos + 1;
+    while (true) {
+        const void* found = std::memchr(text.data() + from, '"', text.size() - from);
+        if (!found) {
+            throw std::runtime_error("Ошибка парсинга JSON: Незакрытая строка");
+        }
+        size_t quote = static_cast<size_t>(static_cast<const char*>(found) - text.data());
+        size_t slashes = 0;
+        while (quote - slashes > pos + 1 && text[quote - slashes - 1] == '\\') slashes++;
+        if (slashes % 2 == 0) return quote + 1;
+        from = quote + 1;
+    }
+}
+
+size_t skipJsonValue(std::string_view text, size_t pos);
+
+/**
+ * @brief Позиция за объектом или массивом, открытым в pos
+ *
+ * Вложенность проверяется рекурсией, как в JsonParser: закрывающая
+ * скобка должна соответствовать открывающей.
+ */
+size_t skipJsonContainer(std::string_view text, size_t pos) {
+    bool object = text[pos] == '{';
+    char close = object ? '}' : ']';
+    pos = skipJsonWhitespace(text, pos + 1);
+    if (pos < text.size() && text[pos] == close) return pos + 1;
+    
+    while (true) {
+        if (object) {
+            if (pos >= text.size() || text[pos] != '"') {
+                throw std::runtime_error("Ошибка парсинга JSON: Ожидается кавычка");
+            }
+            pos = skipJsonWhitespace(text, skipJsonString(text, pos));
+            if (pos >= text.size() || text[pos] != ':') {
+                throw std::runtime_error("Ошибка парсинга JSON: Ожидается ':' после ключа объекта");
+            }
+            pos = skipJsonWhitespace(text, pos + 1);
+        }
+        pos = skipJsonWhitespace(text, skipJsonValue(text, pos));
+        if (pos < text.size() && text[pos] == close) return pos + 1;
+        if (pos >= text.size() || text[pos] != ',') {
+            throw std::runtime_error(object ? "Ошибка парсинга JSON: Ожидается ',' или '}' в объекте"
+                                            : "Ошибка парсинга JSON: Ожидается ',' или ']' в массиве");
+        }
+        pos = skipJsonWhitespace(text, pos + 1);
+    }
+}
+
+/**
+ * @brief Позиция за значением, начинающимся в pos; значение проверяется
+ *
+ * Строки пропускаются до закрывающей кавычки, литералы сравниваются
+ * целиком, числа проверяются по грамматике JSON.
+ */
+size_t skipJsonValue(std::string_view text, size_t pos) {
+    if (pos >= text.size()) {
+        throw std::runtime_error("Ошибка парсинга JSON: Неожиданный конец JSON");
+    }
+    char ch = text[pos];
+    if (ch == '"') return skipJsonString(text, pos);
+    if (ch == '{' || ch == '[') return skipJsonContainer(text, pos);
+    
+    for (std::string_view literal : {"true", "false", "null"}) {
+        if (ch == literal[0]) {
+            if (text.compare(pos, literal.size(), literal) != 0) {
+                throw std::runtime_error("Ошибка парсинга JSON: Неожиданное значение");
+            }
+            return pos + literal.size();
+        }
+    }
+    
+    size_t end = pos;
+    if (!scanJsonNumber(text, end)) {
+        throw std::runtime_error(std::string("Ошибка парсинга JSON: Неожиданный символ в JSON: ") + ch);
+    }
+    return end;
+}
+
+/**
+ * @brief Позиция за значением уже проверенного текста
+ *
+ * Проверка не повторяется: вложенные значения пропускаются по счётчику
+ * скобок с блочным поиском кавычек и скобок, литералы и числа — до
+ * ближайшего разделителя.
+ */
+size_t skipCheckedJsonValue(std::string_view text, size_t pos) {
+    char ch = text[pos];
+    if (ch == '"') return skipJsonString(text, pos);
+    if (ch == '{' || ch == '[') {
+        const char* begin = text.data();
+        const char* end = begin + text.size();
+        int depth = 0;
+        const char* p = begin + pos;
+        while (true) {
+            p = findJsonStructural(p, end);
+            ch = *p++;
+            if (ch == '"') {
+                // Текст проверен, поэтому за '\\' всегда есть экранируемый символ
+                while ((p = findQuoteOrBackslash(p, end)), *p == '\\') p += 2;
+                p++;
+            } else if (ch == '{' || ch == '[') {
+                depth++;
+            } else if (--depth == 0) {
+                return static_cast<size_t>(p - begin);
+            }
+        }
+    }
+    while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && text[pos] != ']' &&
+           !isJsonWhitespace(text[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+} // namespace
+
+// === Потоковое чтение и запись массивов ===
+
+static const size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+JsonArrayReader::JsonArrayReader(std::istream& input)
+    : in(input), chunkPos(0), started(false), finished(false) {}
+
+int JsonArrayReader::peekChar() {
+    if (chunkPos >= chunk.size()) {
+        chunk.resize(STREAM_CHUNK_SIZE);
+        in.read(&chunk[0], chunk.size());
+        chunk.resize(static_cast<size_t>(in.gcount()));
+        chunkPos = 0;
+        if (chunk.empty()) return EOF;
+    }
+    return static_cast<unsigned char>(chunk[chunkPos]);
+}
+
+int JsonArrayReader::getChar() {
+    int ch = peekChar();
+    if (ch != EOF) chunkPos++;
+    return ch;
+}
+
+int JsonArrayReader::skipWhitespace() {
+    int ch = peekChar();
+    while (ch != EOF && isJsonWhitespace(static_cast<char>(ch))) {
+        chunkPos++;
+        ch = peekChar();
+    }
+    return ch;
+}
+
+void JsonArrayReader::readElementText() {
+    // Копируем текст элемента до ',' или ']' на нулевой глубине,
+    // отслеживая вложенность скобок и строки с экранированием
+    elementText.clear();
+    int depth = 0;
+    bool inString = false;
+    
+    while (true) {
+        int ch = peekChar();
+        if (ch == EOF) {
+            throw std::runtime_error("Ошибка парсинга JSON: Неожиданный конец JSON");
+        }
+        
+        if (inString) {
+            // Участок до кавычки или '\\' в пределах блока — одним append
+            const char* run = chunk.data() + chunkPos;
+            const char* stop = findQuoteOrBackslash(run, chunk.data() + chunk.size());
+            elementText.append(run, stop);
+            chunkPos = static_cast<size_t>(stop - chunk.data());
+            if (chunkPos == chunk.size()) continue;   // Блок кончился, строка — нет
+            
+            elementText += *stop;
+            chunkPos++;
+            if (*stop == '\\') {
+                int escaped = getChar();
+                if (escaped == EOF) {
+                    throw std::runtime_error("Ошибка парсинга JSON: Неполное экранирование");
+                }
+                elementText += static_cast<char>(escaped);
+            } else {
+                inString = false;
+            }
+            continue;
+        }
+        
+        if (depth == 0 && (ch == ',' || ch == ']')) break;
+        
+        if (ch == '"') {
+            inString = true;
+        } else if (ch == '[' || ch == '{') {
+            depth++;
+        } else if (ch == ']' || ch == '}') {
+            depth--;
+        }
+        elementText += static_cast<char>(ch);
+        chunkPos++;
+    }
+}
+
+bool JsonArrayReader::next(JsonValue& value) {
+    std::string_view text;
+    if (!nextText(text)) return false;
+    value = parseJson(text);
+    return true;
+}
+
+bool JsonArrayReader::nextText(std::string_view& text) {
+    if (finished) return false;
+    
+    if (!started) {
+        if (skipWhitespace() != '[') {
+            throw std::runtime_error("Ошибка парсинга JSON: Ожидается массив верхнего уровня");
+        }
+        getChar();
+        started = true;
+        
+        if (skipWhitespace() == ']') {
+            getChar();
+            finished = true;
+            return false;
+        }
+    }
+    
+    readElementText();
+    
+    // После элемента — ',' или закрывающая ']'
+    if (getChar() == ']') {
+        finished = true;
+        if (skipWhitespace() != EOF) {
+            throw std::runtime_error("Ошибка парсинга JSON: Дополнительные символы после JSON");
+        }
+    }
+    
+    // Пробелы вокруг элемента попадают в elementText — отрезаем их
+    size_t begin = elementText.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        throw std::runtime_error("Ошибка парсинга JSON: Пустой элемент массива");
+    }
+    size_t end = elementText.find_last_not_of(" \t\r\n") + 1;
+    text = std::string_view(elementText).substr(begin, end - begin);
+    
+    // Скобки и строки уже разобраны при чтении; элемент проверяется
+    // целиком, потому что его текст может уйти в выход как есть
+    if (skipJsonValue(text, 0) != text.size()) {
+        throw std::runtime_error("Ошибка парсинга JSON: Ожидается ',' или ']' в массиве");
+    }
+    return true;
+}
+
+// === Разбор по требованию ===
+
+bool splitJsonArray(std::string_view json, std::vector<std::string_view>& elements) {
+    size_t pos = skipJsonWhitespace(json, 0);
+    if (pos >= json.size() || json[pos] != '[') return false;
+    
+    pos = skipJsonWhitespace(json, pos + 1);
+    if (pos < json.size() && json[pos] == ']') {
+        pos++;
+    } else {
+        while (true) {
+            size_t end = skipJsonValue(json, pos);
+            elements.push_back(json.substr(pos, end - pos));
+            pos = skipJsonWhitespace(json, end);
+            if (pos < json.size() && json[pos] == ']') {
+                pos++;
+                break;
+            }
+            if (pos >= json.size() || json[pos] != ',') {
+                throw std::runtime_error("Ошибка парсинга JSON: Ожидается ',' или ']' в массиве");
+            }
+            pos = skipJsonWhitespace(json, pos + 1);
+        }
+    }
+    
+    if (skipJsonWhitespace(json, pos) < json.size()) {
+        throw std::runtime_error("Ошибка парсинга JSON: Дополнительные символы после JSON на позиции " +
+                                 std::to_string(pos));
+    }
+    return true;
+}
+
+JsonFieldCursor::JsonFieldCursor(std::string_view objectJson, bool validated)
+    : text(objectJson), pos(skipJsonWhitespace(objectJson, 0)), first(true), finished(false),
+      checked(validated) {
+    if (pos >= text.size() || text[pos] != '{') {
+        throw std::runtime_error("Ошибка парсинга JSON: Ожидается объект");
+    }
+    pos++;
+}
+
+bool JsonFieldCursor::next(std::string_view& key, std::string_view& value) {
+    if (finished) return false;
+    
+    pos = skipJsonWhitespace(text, pos);
+    if (pos < text.size() && text[pos] == '}') {
+        finished = true;
+        return false;
+    }
+    if (!first) {
+        if (pos >= text.size() || text[pos] != ',') {
+            throw std::runtime_error("Ошибка парсинга JSON: Ожидается ',' или '}' в объекте");
+        }
+        pos = skipJsonWhitespace(text, pos + 1);
+    }
+    first = false;
+    
+    if (pos >= text.size() || text[pos] != '"') {
+        throw std::runtime_error("Ошибка парсинга JSON: Ожидается кавычка");
+    }
+    size_t keyEnd = skipJsonString(text, pos);
+    key = text.substr(pos + 1, keyEnd - pos - 2);
+    
+    pos = skipJsonWhitespace(text, keyEnd);
+    if (pos >= text.size() || text[pos] != ':') {
+        throw std::runtime_error("Ошибка парсинга JSON: Ожидается ':' после ключа объекта");
+    }
+    pos = skipJsonWhitespace(text, pos + 1);
+    size_t valueEnd = checked ? skipCheckedJsonValue(text, pos) : skipJsonValue(text, pos);
+    value = text.substr(pos, valueEnd - pos);
+    pos = valueEnd;
+    return true;
+}
+
+JsonLazyObject::JsonLazyObject(std::string_view objectJson) : source(objectJson) {}
+
+std::string_view JsonLazyObject::text() const {
+    return source;
+}
+
+bool JsonLazyObject::get(std::string_view key, JsonValue& value) const {
+    auto changed = changes.find(key);
+    if (changed != changes.end()) {
+        value = changed->second;
+        return true;
+    }
+    
+    // Как и в parseJson, из повторяющихся ключей действует последний,
+    // поэтому объект просматривается до конца
+    JsonFieldCursor cursor(source, true);
+    std::string_view name, raw, found;
+    bool hasField = false;
+    while (cursor.next(name, raw)) {
+        if (name == key) {
+            found = raw;
+            hasField = true;
+        }
+    }
+    if (!hasField) return false;
+    
+    // Строка без экранирования — срез текста, парсер не нужен
+    if (found.size() >= 2 && found.front() == '"' && found.find('\\') == std::string_view::npos) {
+        value = JsonValue::borrow(found.substr(1, found.size() - 2));
+    } else {
+        value = parseJson(found, true);
+    }
+    return true;
+}
+
+void JsonLazyObject::reserve(size_t count) {
+    changes.reserve(count);
+}
+
+void JsonLazyObject::insert_or_assign(std::string_view key, JsonValue value) {
+    changes.insert_or_assign(key, std::move(value));
+}
+
+const JsonObject& JsonLazyObject::changedFields() const {
+    return changes;
+}
+
+bool JsonLazyObject::modified() const {
+    return !changes.empty();
+}
+
+JsonArrayWriter::JsonArrayWriter(std::ostream& output, bool prettyOutput)
+    : out(output), pretty(prettyOutput), count(0), finished(false) {
+    buffer.reserve(FLUSH_THRESHOLD * 2);
+    buffer.push_back('[');
+}
+
+// Записи копятся в buffer и уходят в поток порциями по FLUSH_THRESHOLD:
+// запись в поток по каждому элементу стоила бы системного вызова на
+// несколько элементов
+void JsonArrayWriter::write(const JsonValue& value) {
+    if (count > 0) {
+        buffer.append(pretty ? ",\n  " : ", ");
+    }
+    JsonSerializer serializer(buffer, pretty, &out);
+    serializer.write(value, 1);
+    if (buffer.size() >= FLUSH_THRESHOLD) serializer.flush();
+    count++;
+}
+
+void JsonArrayWriter::write(const JsonObject& object) {
+    if (count > 0) {
+        buffer.append(pretty ? ",\n  " : ", ");
+    }
+    JsonSerializer serializer(buffer, pretty, &out);
+    serializer.writeObject(object, 1);
+    if (buffer.size() >= FLUSH_THRESHOLD) serializer.flush();
+    count++;
+}
+
+void JsonArrayWriter::write(const JsonLazyObject& object) {
+    if (!object.modified()) {
+        writeRaw(object.text());
+        return;
+    }
+    if (count > 0) {
+        buffer.append(pretty ? ",\n  " : ", ");
+    }
+    JsonSerializer serializer(buffer, pretty, &out);
+    serializer.writeLazyObject(object, 1, rawFields);
+    if (buffer.size() >= FLUSH_THRESHOLD) serializer.flush();
+    count++;
+}
+
+void JsonArrayWriter::writeRaw(std::string_view json) {
+    if (count > 0) {
+        buffer.append(pretty ? ",\n  " : ", ");
+    }
+    buffer.append(json);
+    if (buffer.size() >= FLUSH_THRESHOLD) {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    count++;
+}
+
+void JsonArrayWriter::finish() {
+    if (finished) return;
+    if (pretty && count > 0) buffer.push_back('\n');
+    buffer.push_back(']');
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+    finished = true;
+}
+
+size_t JsonArrayWriter::size() const {
+    return count;
+}
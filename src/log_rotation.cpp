@@ -0,0 +1,246 @@
+#include "log_rotation.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+std::string logManifestFile(const std::string& logFile) {
+    return logFile + ".manifest";
+}
+
+std::string sealedSegmentPath(const std::string& logFile, const SealedLogSegment& segment) {
+    return (fs::path(logFile).parent_path() / segment.file).string();
+}
+
+LogManifest loadLogManifest(const std::string& logFile) {
+    LogManifest manifest;
+    std::string manifestFile = logManifestFile(logFile);
+    std::error_code error;
+    if (!fs::exists(manifestFile, error)) {
+        return manifest;
+    }
+
+    try {
+        JsonValue data = loadJsonFile(manifestFile);
+        const JsonObject& root = data.asObject();
+        manifest.next = static_cast<uint32_t>(root.at("next").asNumber());
+        for (const auto& item : root.at("segments").asArray()) {
+            const JsonObject& obj = item.asObject();
+            SealedLogSegment segment;
+            segment.file = obj.at("file").asString();
+            segment.compressed = obj.at("compressed").asBoolean();
+            segment.entries = static_cast<uint64_t>(obj.at("entries").asNumber());
+            segment.bytes = static_cast<uint64_t>(obj.at("bytes").asNumber());
+            if (!parseTimestamp(obj.at("from").asString(), segment.firstNs) ||
+                !parseTimestamp(obj.at("to").asString(), segment.lastNs)) {
+                throw std::runtime_error("неверная временная метка");
+            }
+            manifest.segments.push_back(std::move(segment));
+        }
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Повреждён манифест лога " + manifestFile + ": " + e.what());
+    }
+    return manifest;
+}
+
+void saveLogManifest(const std::string& logFile, const LogManifest& manifest) {
+    // Числа пишутся целыми вручную: сериализатор JsonValue выводит их с
+    // шестью значащими цифрами (размер 36011872 стал бы 3.60119e+07)
+    std::string text = "{\n  \"next\": " + std::to_string(manifest.next) + ",\n  \"segments\": [";
+    for (size_t i = 0; i < manifest.segments.size(); i++) {
+        const SealedLogSegment& segment = manifest.segments[i];
+        text += i == 0 ? "\n    {\"bytes\": " : ",\n    {\"bytes\": ";
+        text += std::to_string(segment.bytes);
+        text += segment.compressed ? ", \"compressed\": true" : ", \"compressed\": false";
+        text += ", \"entries\": " + std::to_string(segment.entries);
+        text += ", \"file\": ";
+        appendJsonString(text, segment.file);
+        text += ", \"from\": \"";
+        appendTimestamp(text, segment.firstNs);
+        text += "\", \"to\": \"";
+        appendTimestamp(text, segment.lastNs);
+        text += "\"}";
+    }
+    text += manifest.segments.empty() ? "]\n}\n" : "\n  ]\n}\n";
+
+    std::string manifestFile = logManifestFile(logFile);
+    std::string tempName = manifestFile + ".tmp";
+    {
+        std::ofstream out(tempName, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Не удалось создать файл: " + tempName);
+        }
+        out << text;
+        if (!out) {
+            throw std::runtime_error("Ошибка записи в файл: " + tempName);
+        }
+    }
+
+    std::error_code error;
+    fs::rename(tempName, manifestFile, error);
+    if (error) {
+        fs::remove(tempName, error);
+        throw std::runtime_error("Ошибка записи в файл: " + manifestFile);
+    }
+}
+
+namespace {
+
+/**
+ * @brief Число записей и интервал времени по записям файла
+ */
+void countLogEntries(const std::vector<LogEntry>& entries, SealedLogSegment& segment) {
+    segment.entries = entries.size();
+    segment.firstNs = segment.lastNs = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        int64_t ns = entries[i].timestampNs;
+        segment.firstNs = i == 0 ? ns : std::min(segment.firstNs, ns);
+        segment.lastNs = i == 0 ? ns : std::max(segment.lastNs, ns);
+    }
+}
+
+} // namespace
+
+void sealLogFile(const std::string& logFile, LogManifest& manifest,
+                 const LogRotationOptions& options,
+                 const std::optional<SealedLogSegment>& stats) {
+    SealedLogSegment segment;
+    segment.file = fs::path(logFile).filename().string() + "." + std::to_string(manifest.next);
+    std::string sealedFile = sealedSegmentPath(logFile, segment);
+
+    std::error_code error;
+    if (options.compress) {
+        // Сжатие — перевод в колоночный формат со словарём строк: сегмент
+        // в несколько раз меньше NDJSON и сразу пригоден для запросов.
+        // Сегмент строится до удаления активного файла: при ошибке лог и
+        // манифест остаются прежними
+        sealedFile += ".seg";
+        try {
+            std::vector<LogEntry> entries = readLogFile(logFile);
+            countLogEntries(entries, segment);
+            LogSegment::write(sealedFile, std::move(entries));
+        } catch (...) {
+            fs::remove(sealedFile, error);
+            throw;
+        }
+        fs::remove(logFile, error);
+        if (error) {
+            fs::remove(sealedFile, error);
+            throw std::runtime_error("Не удалось удалить " + logFile + " после сжатия");
+        }
+        segment.file += ".seg";
+        segment.compressed = true;
+    } else {
+        if (stats) {
+            segment.entries = stats->entries;
+            segment.firstNs = stats->firstNs;
+            segment.lastNs = stats->lastNs;
+        } else {
+            countLogEntries(readLogFile(logFile), segment);
+        }
+        fs::rename(logFile, sealedFile, error);
+        if (error) {
+            throw std::runtime_error("Не удалось переименовать " + logFile + " в " + sealedFile);
+        }
+    }
+    manifest.next++;
+    segment.bytes = static_cast<uint64_t>(fs::file_size(sealedFile, error));
+    manifest.segments.push_back(std::move(segment));
+
+    while (options.maxSegments > 0 && manifest.segments.size() > options.maxSegments) {
+        std::string oldFile = sealedSegmentPath(logFile, manifest.segments.front());
+        fs::remove(oldFile, error);
+        fs::remove(oldFile + ".seg", error);   // Индекс несжатого сегмента
+        manifest.segments.erase(manifest.segments.begin());
+    }
+}
+
+namespace {
+
+std::vector<LogEntry> readSealedSegment(const std::string& logFile, const SealedLogSegment& segment) {
+    std::string path = sealedSegmentPath(logFile, segment);
+    if (segment.compressed) {
+        return LogSegment(path).query(LogQuery());
+    }
+    return readLogFile(path);
+}
+
+} // namespace
+
+std::vector<LogEntry> readLogHistory(const std::string& logFile, size_t lastEntries) {
+    LogManifest manifest = loadLogManifest(logFile);
+
+    // Части истории читаются от новых к старым, пока не наберётся lastEntries
+    std::vector<std::vector<LogEntry>> parts;
+    size_t total = 0;
+    std::error_code error;
+    if (fs::exists(logFile, error)) {
+        parts.push_back(readLogFile(logFile));
+        total += parts.back().size();
+    }
+    for (auto it = manifest.segments.rbegin(); it != manifest.segments.rend(); ++it) {
+        if (lastEntries > 0 && total >= lastEntries) break;
+        parts.push_back(readSealedSegment(logFile, *it));
+        total += parts.back().size();
+    }
+
+    std::vector<LogEntry> history;
+    history.reserve(total);
+    for (auto it = parts.rbegin(); it != parts.rend(); ++it) {
+        std::move(it->begin(), it->end(), std::back_inserter(history));
+    }
+    if (lastEntries > 0 && history.size() > lastEntries) {
+        history.erase(history.begin(), history.end() - static_cast<std::ptrdiff_t>(lastEntries));
+    }
+    return history;
+}
+
+std::vector<LogEntry> queryLogHistory(const std::string& logFile, const LogQuery& query,
+                                      size_t& rebuilt, size_t& total) {
+    LogManifest manifest = loadLogManifest(logFile);
+    rebuilt = 0;
+    total = 0;
+
+    std::vector<LogEntry> result;
+    auto queryNdjson = [&](const std::string& path) {
+        std::string segmentFile = path + ".seg";
+        if (refreshLogSegment(path, segmentFile)) {
+            rebuilt++;
+        }
+        LogSegment segment(segmentFile);
+        total += segment.size();
+        std::vector<LogEntry> found = segment.query(query);
+        std::move(found.begin(), found.end(), std::back_inserter(result));
+    };
+
+    for (const auto& sealed : manifest.segments) {
+        // Метки в манифесте — с точностью до секунды
+        if (sealed.firstNs >= query.toNs || sealed.lastNs + 1000000000LL <= query.fromNs) {
+            total += sealed.entries;
+            continue;
+        }
+        std::string path = sealedSegmentPath(logFile, sealed);
+        if (sealed.compressed) {
+            LogSegment segment(path);
+            total += segment.size();
+            std::vector<LogEntry> found = segment.query(query);
+            std::move(found.begin(), found.end(), std::back_inserter(result));
+        } else {
+            queryNdjson(path);
+        }
+    }
+
+    std::error_code error;
+    if (fs::exists(logFile, error)) {
+        queryNdjson(logFile);
+    }
+
+    // Сегменты идут по времени, но записи разных потоков на стыке могут
+    // немного перекрываться
+    std::stable_sort(result.begin(), result.end(), [](const LogEntry& a, const LogEntry& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+    return result;
+}
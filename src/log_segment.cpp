@@ -0,0 +1,351 @@
+#include "log_segment.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const char SEGMENT_MAGIC[8] = {'C', 'A', 'E', 'S', 'L', 'O', 'G', '1'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * @brief Заголовок сегмента (32 байта в начале файла)
+ */
+struct SegmentHeader {
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t blockRows;
+    uint64_t rowCount;
+    uint64_t dictionaryOffset;
+};
+static_assert(sizeof(SegmentHeader) == 32, "Заголовок сегмента должен занимать 32 байта");
+
+/**
+ * @brief Элемент индекса по id
+ */
+struct IdRow {
+    int32_t id;
+    uint32_t row;
+};
+static_assert(sizeof(IdRow) == 8, "Элемент индекса по id должен занимать 8 байтов");
+
+/**
+ * @brief Смещения колонок; все определяются числом строк и блоков
+ */
+struct SegmentLayout {
+    uint64_t time, id, key, operation, status, message, idIndex;
+    uint64_t blockTime, blockId, dictionary;
+
+    SegmentLayout(uint64_t rows, uint64_t blocks) {
+        time = sizeof(SegmentHeader);
+        id = time + rows * sizeof(int64_t);
+        key = id + rows * sizeof(int32_t);
+        operation = key + rows * sizeof(int32_t);
+        status = operation + rows * sizeof(uint32_t);
+        message = status + rows * sizeof(uint32_t);
+        idIndex = message + rows * sizeof(uint32_t);
+        blockTime = idIndex + rows * sizeof(IdRow);
+        blockId = blockTime + blocks * sizeof(int64_t);
+        dictionary = blockId + blocks * sizeof(int32_t);
+    }
+};
+
+uint64_t blockCount(uint64_t rows, uint32_t blockRows) {
+    return (rows + blockRows - 1) / blockRows;
+}
+
+template <typename T>
+void writeArray(std::ofstream& out, const std::vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+} // namespace
+
+// === Чтение сегмента ===
+
+LogSegment::LogSegment(const std::string& filename) : file(filename, std::ios::binary) {
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл: " + filename);
+    }
+
+    SegmentHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        throw std::runtime_error("Файл не является сегментом лога: " + filename);
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Сегмент записан с другим порядком байтов: " + filename);
+    }
+    if (header.blockRows == 0) {
+        throw std::runtime_error("Повреждён заголовок сегмента: " + filename);
+    }
+
+    rowCount = header.rowCount;
+    blockRows = header.blockRows;
+    uint64_t blocks = blockCount(rowCount, blockRows);
+    SegmentLayout layout(rowCount, blocks);
+    if (header.dictionaryOffset != layout.dictionary) {
+        throw std::runtime_error("Повреждён заголовок сегмента: " + filename);
+    }
+
+    // Разреженный индекс и словарь держим в памяти, колонки — нет
+    blockFirstTime.resize(blocks);
+    blockFirstId.resize(blocks);
+    readColumn(layout.blockTime, 0, blocks, blockFirstTime.data());
+    readColumn(layout.blockId, 0, blocks, blockFirstId.data());
+
+    uint32_t count = 0;
+    readColumn(layout.dictionary, 0, 1, &count);
+    dictionary.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t length = 0;
+        std::string text;
+        if (file.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            text.resize(length);
+            file.read(&text[0], length);
+        }
+        if (!file) {
+            throw std::runtime_error("Повреждён словарь сегмента: " + filename);
+        }
+        dictionary.push_back(std::move(text));
+    }
+}
+
+template <typename T>
+void LogSegment::readColumn(uint64_t columnOffset, uint64_t first, uint64_t count, T* out) const {
+    if (count == 0) return;
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(columnOffset + first * sizeof(T)));
+    file.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(count * sizeof(T)));
+    if (!file) {
+        throw std::runtime_error("Сегмент лога обрезан или повреждён");
+    }
+}
+
+size_t LogSegment::size() const {
+    return static_cast<size_t>(rowCount);
+}
+
+LogEntry LogSegment::makeEntry(int64_t time, int32_t id, int32_t key,
+                               uint32_t operation, uint32_t status, uint32_t message) const {
+    if (operation >= dictionary.size() || status >= dictionary.size() ||
+        message >= dictionary.size()) {
+        throw std::runtime_error("Код строки вне словаря сегмента");
+    }
+    LogEntry entry;
+    entry.timestampNs = time;
+    entry.id = id;
+    entry.key = key;
+    entry.operation = dictionary[operation];
+    entry.status = dictionary[status];
+    entry.message = dictionary[message];
+    return entry;
+}
+
+int64_t LogSegment::findCode(const std::string& text) const {
+    auto it = std::find(dictionary.begin(), dictionary.end(), text);
+    return it == dictionary.end() ? -1 : static_cast<int64_t>(it - dictionary.begin());
+}
+
+std::vector<LogEntry> LogSegment::query(const LogQuery& query) const {
+    std::vector<LogEntry> result;
+    if (rowCount == 0 || query.fromNs >= query.toNs) {
+        return result;
+    }
+
+    int64_t operationCode = -1;
+    if (query.operation) {
+        operationCode = findCode(*query.operation);
+        if (operationCode < 0) return result;  // Такой операции в сегменте нет
+    }
+
+    SegmentLayout layout(rowCount, blockFirstTime.size());
+    auto matches = [&](int64_t time, uint32_t operation) {
+        return time >= query.fromNs && time < query.toNs &&
+               (operationCode < 0 || operation == static_cast<uint32_t>(operationCode));
+    };
+
+    if (query.id) {
+        // Блоки индекса по id, в которых может оказаться нужный id:
+        // хвост блока перед первым с firstId >= id и все блоки с firstId == id
+        int32_t target = *query.id;
+        size_t firstBlock = std::lower_bound(blockFirstId.begin(), blockFirstId.end(), target) -
+                            blockFirstId.begin();
+        if (firstBlock > 0) firstBlock--;
+        size_t endBlock = std::upper_bound(blockFirstId.begin(), blockFirstId.end(), target) -
+                          blockFirstId.begin();
+
+        uint64_t first = static_cast<uint64_t>(firstBlock) * blockRows;
+        uint64_t last = std::min<uint64_t>(rowCount, static_cast<uint64_t>(endBlock) * blockRows);
+        std::vector<IdRow> index(last - first);
+        readColumn(layout.idIndex, first, index.size(), index.data());
+
+        // Строки одного id в индексе идут по возрастанию, то есть по времени
+        for (const IdRow& item : index) {
+            if (item.id != target) continue;
+            int64_t time;
+            uint32_t operation, status, message;
+            int32_t key;
+            readColumn(layout.time, item.row, 1, &time);
+            readColumn(layout.operation, item.row, 1, &operation);
+            if (!matches(time, operation)) continue;
+            readColumn(layout.key, item.row, 1, &key);
+            readColumn(layout.status, item.row, 1, &status);
+            readColumn(layout.message, item.row, 1, &message);
+            result.push_back(makeEntry(time, item.id, key, operation, status, message));
+        }
+        return result;
+    }
+
+    // Строки отсортированы по времени: читаем только блоки, пересекающие интервал
+    size_t firstBlock = std::lower_bound(blockFirstTime.begin(), blockFirstTime.end(), query.fromNs) -
+                        blockFirstTime.begin();
+    if (firstBlock > 0) firstBlock--;
+    size_t endBlock = std::lower_bound(blockFirstTime.begin(), blockFirstTime.end(), query.toNs) -
+                      blockFirstTime.begin();
+    if (endBlock <= firstBlock) {
+        return result;
+    }
+
+    uint64_t first = static_cast<uint64_t>(firstBlock) * blockRows;
+    uint64_t count = std::min<uint64_t>(rowCount, static_cast<uint64_t>(endBlock) * blockRows) - first;
+    std::vector<int64_t> times(count);
+    std::vector<uint32_t> operations(count);
+    readColumn(layout.time, first, count, times.data());
+    readColumn(layout.operation, first, count, operations.data());
+
+    // Остальные колонки нужны только в пределах подходящих строк
+    uint64_t begin = count, end = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        if (matches(times[i], operations[i])) {
+            begin = std::min(begin, i);
+            end = i + 1;
+        }
+    }
+    if (begin >= end) {
+        return result;
+    }
+
+    uint64_t span = end - begin;
+    std::vector<int32_t> ids(span), keys(span);
+    std::vector<uint32_t> statuses(span), messages(span);
+    readColumn(layout.id, first + begin, span, ids.data());
+    readColumn(layout.key, first + begin, span, keys.data());
+    readColumn(layout.status, first + begin, span, statuses.data());
+    readColumn(layout.message, first + begin, span, messages.data());
+
+    for (uint64_t i = begin; i < end; i++) {
+        if (!matches(times[i], operations[i])) continue;
+        uint64_t j = i - begin;
+        result.push_back(makeEntry(times[i], ids[j], keys[j], operations[i], statuses[j], messages[j]));
+    }
+    return result;
+}
+
+// === Запись сегмента ===
+
+void LogSegment::write(const std::string& filename, std::vector<LogEntry> entries,
+                       uint32_t blockRows) {
+    if (blockRows == 0) blockRows = 1;
+    std::stable_sort(entries.begin(), entries.end(), [](const LogEntry& a, const LogEntry& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+
+    // Интернирование строк: одинаковые операции, статусы и сообщения — один код
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> codes;
+    auto intern = [&](const std::string& text) {
+        auto [it, inserted] = codes.emplace(text, static_cast<uint32_t>(strings.size()));
+        if (inserted) strings.push_back(text);
+        return it->second;
+    };
+
+    size_t rows = entries.size();
+    std::vector<int64_t> times(rows);
+    std::vector<int32_t> ids(rows), keys(rows);
+    std::vector<uint32_t> operations(rows), statuses(rows), messages(rows);
+    std::vector<IdRow> idIndex(rows);
+    for (size_t i = 0; i < rows; i++) {
+        const LogEntry& entry = entries[i];
+        times[i] = entry.timestampNs;
+        ids[i] = entry.id;
+        keys[i] = entry.key;
+        operations[i] = intern(entry.operation);
+        statuses[i] = intern(entry.status);
+        messages[i] = intern(entry.message);
+        idIndex[i] = {entry.id, static_cast<uint32_t>(i)};
+    }
+    std::sort(idIndex.begin(), idIndex.end(), [](const IdRow& a, const IdRow& b) {
+        return a.id != b.id ? a.id < b.id : a.row < b.row;
+    });
+
+    uint64_t blocks = blockCount(rows, blockRows);
+    std::vector<int64_t> blockTime(blocks);
+    std::vector<int32_t> blockId(blocks);
+    for (uint64_t b = 0; b < blocks; b++) {
+        blockTime[b] = times[b * blockRows];
+        blockId[b] = idIndex[b * blockRows].id;
+    }
+
+    SegmentHeader header;
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.blockRows = blockRows;
+    header.rowCount = rows;
+    header.dictionaryOffset = SegmentLayout(rows, blocks).dictionary;
+
+    std::string tempName = filename + ".tmp";
+    {
+        std::ofstream out(tempName, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Не удалось создать файл: " + tempName);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeArray(out, times);
+        writeArray(out, ids);
+        writeArray(out, keys);
+        writeArray(out, operations);
+        writeArray(out, statuses);
+        writeArray(out, messages);
+        writeArray(out, idIndex);
+        writeArray(out, blockTime);
+        writeArray(out, blockId);
+
+        uint32_t count = static_cast<uint32_t>(strings.size());
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const std::string& text : strings) {
+            uint32_t length = static_cast<uint32_t>(text.size());
+            out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+        if (!out) {
+            throw std::runtime_error("Ошибка записи в файл: " + tempName);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempName, filename, error);
+    if (error) {
+        std::filesystem::remove(tempName, error);
+        throw std::runtime_error("Ошибка записи в файл: " + filename);
+    }
+}
+
+bool refreshLogSegment(const std::string& logFile, const std::string& segmentFile) {
+    namespace fs = std::filesystem;
+    std::error_code error;
+    auto logTime = fs::last_write_time(logFile, error);
+    if (error) {
+        throw std::runtime_error("Не удалось открыть файл: " + logFile);
+    }
+    auto segmentTime = fs::last_write_time(segmentFile, error);
+    if (!error && segmentTime > logTime) {
+        return false;
+    }
+
+    LogSegment::write(segmentFile, readLogFile(logFile));
+    return true;
+}
@@ -1,90 +1,680 @@
 #include "logger.h"
+#include "log_rotation.h"
 #include <fstream>
-#include <sstream>
 #include <iostream>
 #include <iomanip>
 #include <ctime>
 #include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+constexpr int64_t NS_PER_SECOND = 1000000000;
+
+/**
+ * @brief Отформатированная секунда, своя у каждого потока
+ */
+struct TimestampCache {
+    int64_t second = INT64_MIN;
+    char text[32];
+    size_t length = 0;
+};
+
+thread_local TimestampCache timestampCache;
+
+/**
+ * @brief Последняя разобранная минута "YYYY-MM-DDTHH:MM", своя у каждого потока
+ */
+struct ParsedMinuteCache {
+    char minute[16];
+    int64_t epochSecond = 0;    // Начало минуты
+    bool valid = false;
+};
+
+thread_local ParsedMinuteCache parsedMinuteCache;
+
+} // namespace
+
+int64_t currentTimeNs() {
+#if defined(CLOCK_REALTIME_COARSE)
+    // Грубые часы (шаг — тик ядра, единицы мс) читаются без обращения к
+    // счётчику процессора; в логе всё равно хранятся секунды
+    timespec now;
+    if (clock_gettime(CLOCK_REALTIME_COARSE, &now) == 0) {
+        return static_cast<int64_t>(now.tv_sec) * NS_PER_SECOND + now.tv_nsec;
+    }
+#endif
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void appendTimestamp(std::string& out, int64_t epochNs) {
+    int64_t second = epochNs / NS_PER_SECOND;
+    if (epochNs % NS_PER_SECOND < 0) second--;  // Округление вниз для моментов до эпохи
+    
+    TimestampCache& cache = timestampCache;
+    if (second != cache.second) {
+        // localtime_r/localtime_s вместо localtime: вызывается из разных потоков
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm local{};
+#if defined(_WIN32)
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        int written = std::snprintf(cache.text, sizeof(cache.text), "%04d-%02d-%02dT%02d:%02d:%02d",
+                                    local.tm_year + 1900, local.tm_mon + 1, local.tm_mday,
+                                    local.tm_hour, local.tm_min, local.tm_sec);
+        cache.length = written > 0 ? std::min(static_cast<size_t>(written), sizeof(cache.text) - 1) : 0;
+        cache.second = second;
+    }
+    out.append(cache.text, cache.length);
+}
+
+std::string formatTimestamp(int64_t epochNs) {
+    std::string result;
+    appendTimestamp(result, epochNs);
+    return result;
+}
+
+bool parseTimestamp(const std::string& text, int64_t& epochNs) {
+    // Записи лога идут подряд, и минута у соседних почти всегда общая:
+    // mktime (с поиском правил часового пояса) вызывается раз в минуту
+    ParsedMinuteCache& cache = parsedMinuteCache;
+    bool canonical = text.size() == 19 && text[16] == ':' &&
+                     std::isdigit(static_cast<unsigned char>(text[17])) &&
+                     std::isdigit(static_cast<unsigned char>(text[18]));
+    int second = canonical ? (text[17] - '0') * 10 + (text[18] - '0') : 0;
+    if (canonical && second < 60 && cache.valid && text.compare(0, 16, cache.minute, 16) == 0) {
+        epochNs = (cache.epochSecond + second) * NS_PER_SECOND;
+        return true;
+    }
+    
+    std::tm local{};
+    char tail;
+    if (std::sscanf(text.c_str(), "%d-%d-%dT%d:%d:%d%c", &local.tm_year, &local.tm_mon,
+                    &local.tm_mday, &local.tm_hour, &local.tm_min, &local.tm_sec, &tail) != 6) {
+        return false;
+    }
+    local.tm_year -= 1900;
+    local.tm_mon -= 1;
+    local.tm_isdst = -1;
+    std::time_t time = std::mktime(&local);
+    if (time == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    epochNs = static_cast<int64_t>(time) * NS_PER_SECOND;
+    
+    if (canonical && second < 60) {
+        std::memcpy(cache.minute, text.data(), sizeof(cache.minute));
+        cache.epochSecond = static_cast<int64_t>(time) - second;
+        cache.valid = true;
+    }
+    return true;
+}
 
 std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
+    return formatTimestamp(currentTimeNs());
+}
+
+/**
+ * @brief Узел очереди асинхронного логгера
+ *
+ * Узлы не освобождаются, а возвращаются в пул и переиспользуются.
+ * Операция и статус из словаря LOG_WORDS хранятся кодом; сообщение и
+ * слова вне словаря — в строках узла, ёмкость которых сохраняется между
+ * использованиями. Поэтому после прогрева log() не выделяет память.
+ */
+struct AsyncLogNode {
+    AsyncLogNode* next = nullptr;
+    int64_t timestampNs = 0;
+    int key = 0;
+    int id = 0;
+    uint8_t operationCode = 0;      // Индекс в LOG_WORDS; OTHER_WORD — в operationText
+    uint8_t statusCode = 0;
+    std::string operationText;
+    std::string statusText;
+    std::string message;
+};
+
+namespace {
+
+// Операции и статусы, которые пишет программа
+const char* const LOG_WORDS[] = {"encrypt", "decrypt", "crack", "успешно", "ошибка"};
+constexpr uint8_t OTHER_WORD = UINT8_MAX;
+
+uint8_t encodeLogWord(const std::string& word, std::string& text) {
+    for (uint8_t code = 0; code < std::size(LOG_WORDS); code++) {
+        if (word == LOG_WORDS[code]) return code;
+    }
+    text = word;
+    return OTHER_WORD;
+}
+
+const std::string& decodeLogWord(uint8_t code, const std::string& text) {
+    static const std::string words[] = {LOG_WORDS[0], LOG_WORDS[1], LOG_WORDS[2], LOG_WORDS[3], LOG_WORDS[4]};
+    return code == OTHER_WORD ? text : words[code];
+}
+
+/**
+ * @brief Пул свободных узлов, общий для всех логгеров
+ *
+ * Писатель возвращает в общий стек всю разобранную порцию одним CAS.
+ * Производитель забирает общий стек целиком (exchange) в кэш своего
+ * потока и берёт узлы оттуда: снятие по одному узлу из общего стека
+ * подвержено ABA, а exchange и вставка — нет.
+ */
+struct AsyncLogNodePool {
+    std::atomic<AsyncLogNode*> head{nullptr};
     
-    std::ostringstream oss;
-    oss << std::put_time(std::localtime(&time), "%Y-%m-%dT%H:%M:%S");
-    return oss.str();
+    void release(AsyncLogNode* first, AsyncLogNode* last) {
+        last->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(last->next, first,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+};
+
+// Без деструктора: глобальный Logger дописывает очередь в своём деструкторе
+// и может вернуть узлы уже после разрушения статических объектов этого файла
+AsyncLogNodePool nodePool;
+
+/**
+ * @brief Узлы, забранные потоком из пула; при выходе потока возвращаются
+ */
+struct AsyncLogNodeCache {
+    AsyncLogNode* nodes = nullptr;
+    
+    ~AsyncLogNodeCache() {
+        if (!nodes) return;
+        AsyncLogNode* last = nodes;
+        while (last->next) last = last->next;
+        nodePool.release(nodes, last);
+    }
+};
+
+thread_local AsyncLogNodeCache nodeCache;
+
+AsyncLogNode* acquireNode() {
+    AsyncLogNode* node = nodeCache.nodes;
+    if (!node) {
+        node = nodePool.head.exchange(nullptr, std::memory_order_acquire);
+        if (!node) return new AsyncLogNode();   // Пул пуст — он растёт до числа записей в очереди
+    }
+    nodeCache.nodes = node->next;
+    return node;
+}
+
+} // namespace
+
+std::string LogEntry::timestamp() const {
+    return formatTimestamp(timestampNs);
 }
 
 JsonValue LogEntry::toJson() const {
-    JsonValue obj;
-    obj.type = JsonType::Object;
-    obj.objectValue["timestamp"] = JsonValue(timestamp);
-    obj.objectValue["operation"] = JsonValue(operation);
-    obj.objectValue["key"] = JsonValue(static_cast<double>(key));
-    obj.objectValue["id"] = JsonValue(static_cast<double>(id));
-    obj.objectValue["status"] = JsonValue(status);
-    obj.objectValue["message"] = JsonValue(message);
-    return obj;
+    JsonObject obj;
+    obj["timestamp"] = JsonValue(timestamp());
+    obj["operation"] = JsonValue(operation);
+    obj["key"] = JsonValue(static_cast<double>(key));
+    obj["id"] = JsonValue(static_cast<double>(id));
+    obj["status"] = JsonValue(status);
+    obj["message"] = JsonValue(message);
+    return JsonValue(std::move(obj));
+}
+
+void LogEntry::appendJsonLine(std::string& out) const {
+    using namespace std::string_view_literals;
+    // Ключи в том же (алфавитном) порядке, что и у JsonObject
+    char number[16];
+    out.append("{\"id\": "sv);
+    out.append(number, std::to_chars(number, number + sizeof(number), id).ptr);
+    out.append(", \"key\": "sv);
+    out.append(number, std::to_chars(number, number + sizeof(number), key).ptr);
+    out.append(", \"message\": "sv);
+    appendJsonString(out, message);
+    out.append(", \"operation\": "sv);
+    appendJsonString(out, operation);
+    out.append(", \"status\": "sv);
+    appendJsonString(out, status);
+    out.append(", \"timestamp\": \""sv);
+    appendTimestamp(out, timestampNs);
+    out.append("\"}\n"sv);
 }
 
 LogEntry LogEntry::fromJson(const JsonValue& value) {
     LogEntry entry;
-    if (value.type == JsonType::Object) {
-        entry.timestamp = value.objectValue.at("timestamp").asString();
-        entry.operation = value.objectValue.at("operation").asString();
-        entry.key = static_cast<int>(value.objectValue.at("key").asNumber());
-        entry.id = static_cast<int>(value.objectValue.at("id").asNumber());
-        entry.status = value.objectValue.at("status").asString();
-        entry.message = value.objectValue.at("message").asString();
+    if (value.type() == JsonType::Object) {
+        const JsonObject& obj = value.asObject();
+        if (!parseTimestamp(obj.at("timestamp").asString(), entry.timestampNs)) {
+            entry.timestampNs = 0;
+        }
+        entry.operation = obj.at("operation").asString();
+        entry.key = static_cast<int>(obj.at("key").asNumber());
+        entry.id = static_cast<int>(obj.at("id").asNumber());
+        entry.status = obj.at("status").asString();
+        entry.message = obj.at("message").asString();
     }
     return entry;
 }
 
+namespace {
+
+/**
+ * @brief Первый непробельный символ потока или EOF
+ */
+int firstSignificantChar(std::istream& input) {
+    int ch;
+    while ((ch = input.get()) != EOF) {
+        if (ch != ' ' && ch != '\n' && ch != '\r' && ch != '\t') break;
+    }
+    return ch;
+}
+
+} // namespace
+
+std::vector<LogEntry> readLogFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Не удалось открыть файл: " + filename);
+    }
+    
+    std::vector<LogEntry> result;
+    if (firstSignificantChar(file) == '[') {
+        // Старый формат: весь лог — один JSON-массив
+        file.close();
+        JsonValue data = loadJsonFile(filename);
+        for (const auto& item : data.asArray()) {
+            result.push_back(LogEntry::fromJson(item));
+        }
+        return result;
+    }
+    
+    file.clear();
+    file.seekg(0);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        try {
+            JsonValue value = parseJson(line);
+            if (value.type() == JsonType::Object) {
+                result.push_back(LogEntry::fromJson(value));
+            }
+        } catch (const std::exception&) {
+            // Повреждённая строка (например, недописанная) пропускается
+        }
+    }
+    return result;
+}
+
+bool convertLogFile(const std::string& filename) {
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open() || firstSignificantChar(file) != '[') {
+            return false;  // Файла нет или он уже в NDJSON
+        }
+    }
+    
+    std::vector<LogEntry> history = readLogFile(filename);
+    std::string tempName = filename + ".tmp";
+    {
+        std::ofstream out(tempName, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Не удалось создать файл: " + tempName);
+        }
+        std::string buffer;
+        for (const auto& entry : history) {
+            entry.appendJsonLine(buffer);
+        }
+        out << buffer;
+        if (!out) {
+            throw std::runtime_error("Ошибка записи в файл: " + tempName);
+        }
+    }
+    
+    std::error_code error;
+    std::filesystem::rename(tempName, filename, error);
+    if (error) {
+        std::filesystem::remove(tempName, error);
+        throw std::runtime_error("Ошибка записи в файл: " + filename);
+    }
+    return true;
+}
+
 Logger::Logger(const std::string& filename) : logFile(filename) {
-    // Пытаемся загрузить существующие логи
-    loadFromFile();
+    // История не читается; проверяется только формат файла
+    try {
+        convertLogFile(logFile);
+    } catch (const std::exception& e) {
+        // Дописывать строки в конец JSON-массива нельзя
+        std::cerr << "Ошибка при переводе лога в NDJSON: " << e.what() << std::endl;
+        writable = false;
+    }
+}
+
+Logger::~Logger() {
+    stopAsync();
+}
+
+bool Logger::openForAppend() {
+    if (output.is_open()) return true;
+    if (!writable) return false;
+    
+    output.open(logFile, std::ios::binary | std::ios::app);
+    if (!output.is_open()) {
+        std::cerr << "Не удалось открыть файл логов: " << logFile << std::endl;
+        writable = false;
+        return false;
+    }
+    return true;
+}
+
+void Logger::appendEntry(LogEntry&& entry, std::string& buffer) {
+    entry.appendJsonLine(buffer);
+    
+    // Интервал времени активного файла (записи потоков могут прийти не по порядку)
+    if (activeEntries == 0 && activeCounted) {
+        activeFirstNs = activeLastNs = entry.timestampNs;
+    } else {
+        activeFirstNs = std::min(activeFirstNs, entry.timestampNs);
+        activeLastNs = std::max(activeLastNs, entry.timestampNs);
+    }
+    activeEntries++;
+    
+    storeEntry(std::move(entry));
+}
+
+void Logger::storeEntry(LogEntry&& entry) {
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    size_t limit = rotation.maxEntriesInMemory;
+    if (limit == 0 || entries.size() < limit) {
+        entries.push_back(std::move(entry));
+        return;
+    }
+    // Буфер заполнен: новая запись занимает место самой старой
+    entries[entriesHead] = std::move(entry);
+    entriesHead = (entriesHead + 1) % entries.size();
+}
+
+void Logger::writeBuffer(const std::string& buffer, bool flush) {
+    if (buffer.empty() || !openForAppend()) return;
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    if (flush) {
+        output.flush();
+    }
+    activeBytes += buffer.size();
+}
+
+void Logger::rotateIfNeeded(int64_t nextNs, std::string& pending) {
+    if (activeEntries == 0 && activeCounted) return;
+    
+    bool full = rotation.maxBytes > 0 && activeBytes + pending.size() >= rotation.maxBytes;
+    int64_t maxAgeNs = static_cast<int64_t>(rotation.maxAge.count()) * NS_PER_SECOND;
+    bool expired = maxAgeNs > 0 && nextNs - activeFirstNs >= maxAgeNs;
+    if (!full && !expired) return;
+    
+    writeBuffer(pending, false);
+    pending.clear();
+    rotate();
+}
+
+void Logger::rotate() {
+    output.close();
+    
+    // Если в файле есть записи прежних запусков, sealLogFile посчитает их сам
+    std::optional<SealedLogSegment> stats;
+    if (activeCounted) {
+        stats.emplace();
+        stats->entries = activeEntries;
+        stats->firstNs = activeFirstNs;
+        stats->lastNs = activeLastNs;
+    }
+    try {
+        LogManifest manifest = loadLogManifest(logFile);
+        sealLogFile(logFile, manifest, rotation, stats);
+        saveLogManifest(logFile, manifest);
+    } catch (const std::exception& e) {
+        // Запись продолжается в тот же файл, без ротации
+        std::cerr << "Ошибка ротации лога, ротация отключена: " << e.what() << std::endl;
+        rotation.maxBytes = 0;
+        rotation.maxAge = std::chrono::seconds(0);
+        return;
+    }
+    
+    activeBytes = 0;
+    activeEntries = 0;
+    activeCounted = true;
+}
+
+void Logger::setRotation(const LogRotationOptions& options) {
+    {
+        // Записи в памяти сохраняются в порядке от старых к новым
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        std::rotate(entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(entriesHead), entries.end());
+        entriesHead = 0;
+        if (options.maxEntriesInMemory > 0 && entries.size() > options.maxEntriesInMemory) {
+            entries.erase(entries.begin(), entries.end() - static_cast<std::ptrdiff_t>(options.maxEntriesInMemory));
+        }
+    }
+    rotation = options;
+    
+    // Размер и интервал времени уже записанного активного файла
+    if (output.is_open()) {
+        output.flush();
+    }
+    activeBytes = 0;
+    activeEntries = 0;
+    activeCounted = true;
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(logFile, error);
+    if (error || size == 0 || (rotation.maxBytes == 0 && rotation.maxAge.count() == 0)) {
+        return;
+    }
+    activeBytes = size;
+    activeCounted = false;
+    
+    // Для порога возраста достаточно первой строки: файл не читается
+    // целиком при каждом запуске. Число записей посчитает sealLogFile
+    activeFirstNs = activeLastNs = currentTimeNs();
+    std::ifstream file(logFile, std::ios::binary);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        try {
+            JsonValue value = parseJson(line);
+            if (value.type() == JsonType::Object) {
+                activeFirstNs = activeLastNs = LogEntry::fromJson(value).timestampNs;
+            }
+        } catch (const std::exception&) {
+            // Нечитаемая строка: возраст отсчитывается от запуска
+        }
+        break;
+    }
 }
 
 void Logger::log(const std::string& operation, int key, int id,
                  const std::string& status, const std::string& message) {
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        AsyncLogNode* node = acquireNode();
+        node->timestampNs = currentTimeNs();
+        node->key = key;
+        node->id = id;
+        node->operationCode = encodeLogWord(operation, node->operationText);
+        node->statusCode = encodeLogWord(status, node->statusText);
+        node->message = message;
+        node->next = queueHead.load(std::memory_order_relaxed);
+        while (!queueHead.compare_exchange_weak(node->next, node,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        }
+        // Писатель будится только на пороге порции, иначе — по таймеру
+        uint64_t queued = enqueuedCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (queued % asyncOptions.batchEntries == 0) {
+            wakeWriter.notify_one();
+        }
+        return;
+    }
+    
     LogEntry entry;
-    entry.timestamp = getCurrentTimestamp();
+    entry.timestampNs = currentTimeNs();
     entry.operation = operation;
     entry.key = key;
     entry.id = id;
     entry.status = status;
     entry.message = message;
     
-    entries.push_back(entry);
+    // Одна строка в конец файла вместо перезаписи всего лога
+    lineBuffer.clear();
+    rotateIfNeeded(entry.timestampNs, lineBuffer);
+    appendEntry(std::move(entry), lineBuffer);
+    writeBuffer(lineBuffer, false);
 }
 
-bool Logger::saveToFile() {
-    try {
-        JsonValue arr;
-        arr.type = JsonType::Array;
+size_t Logger::drainQueue() {
+    AsyncLogNode* node = queueHead.exchange(nullptr, std::memory_order_acquire);
+    
+    // Стек хранит записи от новых к старым — разворачиваем
+    AsyncLogNode* ordered = nullptr;
+    while (node) {
+        AsyncLogNode* next = node->next;
+        node->next = ordered;
+        ordered = node;
+        node = next;
+    }
+    
+    size_t count = 0;
+    std::string buffer;
+    AsyncLogNode* first = ordered;
+    AsyncLogNode* last = nullptr;
+    for (AsyncLogNode* node = ordered; node; node = node->next) {
+        // Строки копируются, а не переносятся: узел вернётся в пул со своей ёмкостью
+        LogEntry entry;
+        entry.timestampNs = node->timestampNs;
+        entry.operation = decodeLogWord(node->operationCode, node->operationText);
+        entry.key = node->key;
+        entry.id = node->id;
+        entry.status = decodeLogWord(node->statusCode, node->statusText);
+        entry.message = node->message;
+        rotateIfNeeded(entry.timestampNs, buffer);
+        appendEntry(std::move(entry), buffer);
+        last = node;
+        count++;
+    }
+    if (first) {
+        nodePool.release(first, last);
+    }
+    
+    // Одна запись и сброс на диск на всю порцию
+    writeBuffer(buffer, true);
+    return count;
+}
+
+void Logger::writerLoop() {
+    std::unique_lock<std::mutex> lock(asyncMutex);
+    while (true) {
+        wakeWriter.wait_for(lock, asyncOptions.flushInterval, [this]() {
+            // Узел попадает в очередь раньше, чем учитывается в enqueuedCount,
+            // поэтому writtenCount может его ненадолго обогнать
+            uint64_t queued = enqueuedCount.load(std::memory_order_relaxed);
+            return stopRequested || writtenCount < flushTarget ||
+                   (queued > writtenCount && queued - writtenCount >= asyncOptions.batchEntries);
+        });
+        bool stopping = stopRequested;
         
-        for (const auto& entry : entries) {
-            arr.arrayValue.push_back(entry.toJson());
-        }
+        lock.unlock();
+        size_t written = drainQueue();
+        lock.lock();
         
-        saveJsonFile(logFile, arr, true);
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Ошибка при сохранении логов: " << e.what() << std::endl;
+        writtenCount += written;
+        batchWritten.notify_all();
+        if (stopping) break;
+    }
+}
+
+void Logger::startAsync(const AsyncLogOptions& options) {
+    if (asyncEnabled.load()) return;
+    
+    // Строки, накопленные синхронным режимом, уходят на диск раньше очереди
+    if (output.is_open()) {
+        output.flush();
+    }
+    
+    asyncOptions = options;
+    if (asyncOptions.batchEntries == 0) {
+        asyncOptions.batchEntries = 1;
+    }
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        stopRequested = false;
+        writtenCount = 0;
+        flushTarget = 0;
+    }
+    enqueuedCount.store(0);
+    writerThread = std::thread(&Logger::writerLoop, this);
+    asyncEnabled.store(true, std::memory_order_release);
+}
+
+void Logger::stopAsync() {
+    if (!asyncEnabled.load()) return;
+    asyncEnabled.store(false, std::memory_order_release);
+    
+    {
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        stopRequested = true;
+    }
+    wakeWriter.notify_one();
+    writerThread.join();
+    
+    // Записи, поставленные в очередь после последней порции писателя
+    drainQueue();
+}
+
+bool Logger::isAsync() const {
+    return asyncEnabled.load(std::memory_order_acquire);
+}
+
+bool Logger::saveToFile() {
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        // Ждём, пока писатель запишет всё, что уже стоит в очереди
+        std::unique_lock<std::mutex> lock(asyncMutex);
+        uint64_t target = enqueuedCount.load(std::memory_order_relaxed);
+        flushTarget = std::max(flushTarget, target);
+        wakeWriter.notify_one();
+        batchWritten.wait(lock, [&]() { return writtenCount >= target; });
+        return writable;
+    }
+    
+    if (!output.is_open()) {
+        return writable;  // Дописывать нечего
+    }
+    
+    output.flush();
+    if (!output) {
+        std::cerr << "Ошибка при сохранении логов: Ошибка записи в файл: " << logFile << std::endl;
         return false;
     }
+    return true;
 }
 
 bool Logger::loadFromFile() {
     try {
-        JsonValue data = loadJsonFile(logFile);
-        entries.clear();
-        
-        if (data.type == JsonType::Array) {
-            for (const auto& item : data.arrayValue) {
-                entries.push_back(LogEntry::fromJson(item));
-            }
-        }
+        saveToFile();  // Чтобы прочитать и записи этой сессии
+        std::vector<LogEntry> history = readLogHistory(logFile, rotation.maxEntriesInMemory);
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        entries = std::move(history);
+        entriesHead = 0;
         return true;
     } catch (...) {
         // Файл не существует или пуст - это нормально
@@ -92,19 +682,27 @@ bool Logger::loadFromFile() {
     }
 }
 
-const std::vector<LogEntry>& Logger::getEntries() const {
-    return entries;
+std::vector<LogEntry> Logger::getEntries() const {
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    std::vector<LogEntry> ordered;
+    ordered.reserve(entries.size());
+    ordered.insert(ordered.end(), entries.begin() + static_cast<std::ptrdiff_t>(entriesHead), entries.end());
+    ordered.insert(ordered.end(), entries.begin(), entries.begin() + static_cast<std::ptrdiff_t>(entriesHead));
+    return ordered;
 }
 
 void Logger::clear() {
+    std::lock_guard<std::mutex> lock(entriesMutex);
     entries.clear();
+    entriesHead = 0;
 }
 
 size_t Logger::size() const {
+    std::lock_guard<std::mutex> lock(entriesMutex);
     return entries.size();
 }
 
-void Logger::printToConsole() const {
+void printLogEntries(const std::vector<LogEntry>& entries, bool fullTimestamp) {
     if (entries.empty()) {
         std::cout << "Логи пусты.\n";
         return;
@@ -125,8 +723,9 @@ void Logger::printToConsole() const {
     std::cout << std::string(70, '-') << "\n";
     
     for (const auto& entry : entries) {
+        std::string time = entry.timestamp();
         std::cout << std::left
-                  << std::setw(20) << entry.timestamp.substr(11, 8)  // Только время
+                  << std::setw(20) << (fullTimestamp ? time : time.substr(11, 8))
                   << std::setw(10) << entry.operation
                   << std::setw(5) << entry.key
                   << std::setw(5) << entry.id
@@ -136,3 +735,7 @@ void Logger::printToConsole() const {
     
     std::cout << "\nВсего операций: " << entries.size() << "\n";
 }
+
+void Logger::printToConsole() const {
+    printLogEntries(getEntries(), false);
+}
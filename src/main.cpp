@@ -15,23 +15,89 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
 #include "cipher.h"
 #include "json_parser.h"
 #include "logger.h"
+#include "log_segment.h"
+#include "log_rotation.h"
+#include "stats.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // === Глобальные переменные ===
-vector<map<string, JsonValue>> currentData;
+vector<JsonLazyObject> currentData;
+JsonDocument currentDocument;  // Владеет буфером, на который ссылаются записи currentData
 Logger logger("data/operations.log");
 string currentInputFile;
+unordered_multimap<int, size_t> recordIndex;  // id → позиция в currentData (строится для --ids)
+unsigned threadCount = 0;  // --threads; 0 — по числу аппаратных потоков
+string statsJsonFile;      // --stats-json; пусто — статистика в stderr
+bool quietMode = false;    // --quiet: только итог, без превью каждой записи
+streambuf* stdoutBuffer = nullptr;  // --output -: stdout занят результатом
 
 // === Вспомогательные функции ===
 
+/**
+ * @brief true, если поток — терминал (а не файл или канал)
+ */
+bool isTerminal(FILE* stream) {
+#if defined(_WIN32)
+    return _isatty(_fileno(stream)) != 0;
+#else
+    return isatty(fileno(stream)) != 0;
+#endif
+}
+
+/**
+ * @brief Переводит stdin/stdout в двоичный режим (на Windows иначе
+ * подменяются переводы строк)
+ */
+void setBinaryMode(FILE* stream) {
+#if defined(_WIN32)
+    _setmode(_fileno(stream), _O_BINARY);
+#else
+    (void)stream;
+#endif
+}
+
+/**
+ * @brief Отдаёт stdout под результат (--output -)
+ *
+ * Результат пишется прямо в буфер stdout, а cout перенаправляется в
+ * stderr, чтобы сообщения программы не смешивались с JSON.
+ */
+void reserveStdoutForResults() {
+    setBinaryMode(stdout);
+    stdoutBuffer = cout.rdbuf(cerr.rdbuf());
+}
+
+/**
+ * @brief Имя файла для сообщений: "-" — стандартный поток
+ */
+string displayName(const string& filename, const char* standardStream) {
+    return filename == "-" ? standardStream : filename;
+}
+
 void printHeader() {
     cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
     cout << "║            ШИФР ЦЕЗАРЯ - ИТОГОВАЯ ЛАБОРАТОРНАЯ РАБОТА        ║\n";
@@ -49,12 +115,37 @@ void printHelp() {
     
     cout << "ОПЦИИ КОМАНДНОЙ СТРОКИ:\n";
     cout << "  --help              Показать эту справку\n";
-    cout << "  --mode ENC|DEC      Режим: enc (шифрование), dec (дешифрование)\n";
-    cout << "  --key N             Ключ сдвига (1-25 для англ., 1-32 для русс.)\n";
+    cout << "  --mode ENC|DEC|CRACK  Режим: enc (шифрование), dec (дешифрование),\n";
+    cout << "                      crack (подбор ключа по частотам букв)\n";
+    cout << "  --key N             Ключ сдвига (1-25 для англ., 1-32 для русс.; не нужен для crack)\n";
     cout << "  --key random        Использовать случайный ключ\n";
-    cout << "  --input FILE        Входной JSON файл\n";
-    cout << "  --output FILE       Выходной JSON файл\n";
-    cout << "  --ids ID1,ID2,ID3   Обработать только эти ID (опционально)\n\n";
+    cout << "  --input FILE        Входной JSON файл (- — stdin)\n";
+    cout << "  --output FILE       Выходной JSON файл (- — stdout, сообщения — в stderr)\n";
+    cout << "  --lang E|R          Язык: E — английский (по умолчанию), R — русский\n";
+    cout << "  --ids ID1,ID2,ID3   Обработать только эти ID (опционально)\n";
+    cout << "  --threads N         Число потоков обработки (по умолчанию — все ядра)\n";
+    cout << "  --jobs FILE         Выполнить задания из манифеста JSON в пуле потоков\n";
+    cout << "  --stream            Потоковый режим: записи читаются и пишутся по одной\n";
+    cout << "  --async-log         Лог пишет фоновый поток, потоки обработки не ждут записи\n";
+    cout << "  --quiet             Только итог, без превью каждой записи\n";
+    cout << "                      (включён сам, если вывод не в терминал)\n";
+    cout << "  --verbose           Превью каждой записи и при выводе не в терминал\n";
+    cout << "  --stats             Время, байты, записи, аллокации и пик RSS по этапам (в stderr)\n";
+    cout << "  --stats-json FILE   То же, но в JSON файл\n\n";
+    
+    cout << "РОТАЦИЯ ЛОГА:\n";
+    cout << "  --log-max-size N    Закрывать лог в сегмент, когда он достиг N байт\n";
+    cout << "  --log-max-age SEC   Закрывать лог в сегмент, когда он старше SEC секунд\n";
+    cout << "  --log-compress      Сжимать закрытые сегменты в бинарный формат\n";
+    cout << "  --log-keep N        Хранить не больше N сегментов\n\n";
+    
+    cout << "ЗАПРОСЫ К ЛОГУ:\n";
+    cout << "  --log-query         Показать записи лога по условиям ниже\n";
+    cout << "  --log-file FILE     Файл лога (по умолчанию data/operations.log)\n";
+    cout << "  --id N              Только операции над записью N\n";
+    cout << "  --operation NAME    Только encrypt или decrypt\n";
+    cout << "  --from TIME         Не раньше TIME (YYYY-MM-DDTHH:MM:SS)\n";
+    cout << "  --to TIME           Не позже TIME (включительно)\n\n";
     
     cout << "ПРИМЕРЫ:\n";
     cout << "  caesar_cipher\n";
@@ -66,12 +157,25 @@ void printHelp() {
     cout << "  caesar_cipher --mode dec --key 7 --input encrypted.json --output decrypted.json\n";
     cout << "    Расшифровать с ключом 7\n\n";
     
+    cout << "  caesar_cipher --mode crack --input encrypted.json --output cracked.json\n";
+    cout << "    Подобрать ключ каждой записи и расшифровать (язык — по тексту или --lang)\n\n";
+    
+    cout << "  cat input.json | caesar_cipher --mode enc --key 7 --input - --output - --stream\n";
+    cout << "    Шифрование в конвейере: stdin → stdout\n\n";
+    
+    cout << "  caesar_cipher --jobs nightly.json --threads 8\n";
+    cout << "    Задания [{\"input\", \"output\", \"mode\", \"key\", \"lang\"}, ...] в одном процессе\n\n";
+    
+    cout << "  caesar_cipher --log-query --id 3 --from 2025-12-21T00:00:00\n";
+    cout << "    Операции над записью 3 начиная с 21 декабря\n\n";
+    
     cout << "ИНТЕРАКТИВНОЕ МЕНЮ:\n";
     cout << "  1 - Загрузить данные из JSON файла\n";
     cout << "  2 - Зашифровать текст\n";
     cout << "  3 - Расшифровать текст\n";
     cout << "  4 - Показать логи операций\n";
     cout << "  5 - Сохранить результаты в файл\n";
+    cout << "  6 - Подобрать ключ и расшифровать\n";
     cout << "  0 - Выход\n\n";
 }
 
@@ -84,30 +188,59 @@ void printMenu() {
     cout << "│ 3 - Расшифровать текст        │\n";
     cout << "│ 4 - Показать логи операций    │\n";
     cout << "│ 5 - Сохранить результаты      │\n";
+    cout << "│ 6 - Подобрать ключ            │\n";
     cout << "│ 0 - Выход                     │\n";
     cout << "└────────────────────────────────┘\n";
-    cout << "\nВыберите пункт (0-5): ";
+    cout << "\nВыберите пункт (0-6): ";
 }
 
-bool loadJsonData(const string& filename) {
+/**
+ * @brief Загружает записи в currentData
+ *
+ * @param indexIds Построить recordIndex по полю id во время загрузки
+ */
+bool loadJsonData(const string& filename, bool indexIds = false) {
     try {
         currentInputFile = filename;
-        JsonValue data = loadJsonFile(filename);
-        currentData.clear();
+        // Файл отображается в память и целиком не разбирается: запись —
+        // срез текста, её поля разбираются при обращении (JsonLazyObject)
+        JsonDocument document;
+        vector<string_view> elements;
+        {
+            StageTimer stage("load_json");
+            if (filename == "-") {
+                setBinaryMode(stdin);
+                document = JsonDocument(cin, JsonParseMode::OnDemand);
+            } else {
+                document = JsonDocument(filename, JsonParseMode::OnDemand);
+            }
+            if (!splitJsonArray(document.text(), elements)) {
+                parseJson(document.text());   // Не массив: записей нет, но текст проверяется
+            }
+            stage.addBytes(document.size());
+        }
         
-        if (data.type == JsonType::Array) {
-            for (const auto& item : data.arrayValue) {
-                if (item.type == JsonType::Object) {
-                    map<string, JsonValue> record;
-                    for (const auto& [key, value] : item.objectValue) {
-                        record[key] = value;
-                    }
-                    currentData.push_back(record);
-                }
+        StageTimer stage("copy_records");
+        currentData.clear();
+        recordIndex.clear();
+        currentData.reserve(elements.size());
+        if (indexIds) {
+            recordIndex.reserve(elements.size());
+        }
+        JsonValue id;
+        for (string_view element : elements) {
+            if (element[0] != '{') continue;
+            currentData.emplace_back(element);
+            if (indexIds && currentData.back().get("id", id) && id.type() == JsonType::Number) {
+                recordIndex.emplace(static_cast<int>(id.asNumber()), currentData.size() - 1);
             }
         }
+        stage.addRecords(currentData.size());
         
-        cout << "✓ Загружено " << currentData.size() << " записей из " << filename << "\n";
+        // Старый документ освобождается только после очистки currentData
+        currentDocument = move(document);
+        
+        cout << "✓ Загружено " << currentData.size() << " записей из " << displayName(filename, "stdin") << "\n";
         return true;
     } catch (const exception& e) {
         cout << "✗ Ошибка при загрузке файла: " << e.what() << "\n";
@@ -115,65 +248,570 @@ bool loadJsonData(const string& filename) {
     }
 }
 
-void processEncryption(int key, char lang, bool isEncryption) {
+/**
+ * @brief Что делать с записями
+ */
+enum class CipherMode {
+    Encrypt,
+    Decrypt,
+    Crack       // Подобрать ключ по частотам букв и расшифровать им
+};
+
+/**
+ * @brief Имя операции для поля operation и лога
+ */
+string operationName(CipherMode mode) {
+    switch (mode) {
+        case CipherMode::Encrypt: return "encrypt";
+        case CipherMode::Decrypt: return "decrypt";
+        default:                  return "crack";
+    }
+}
+
+/**
+ * @brief Заголовок операции для консоли
+ */
+string operationTitle(CipherMode mode, int key) {
+    switch (mode) {
+        case CipherMode::Encrypt: return "Шифрование (ключ = " + to_string(key);
+        case CipherMode::Decrypt: return "Расшифрование (ключ = " + to_string(key);
+        default:                  return "Подбор ключа (по частотам букв";
+    }
+}
+
+/**
+ * @brief Запись лога, отложенная до слияния результатов потоков
+ */
+struct PendingLog {
+    int key;        // Ключ, которым обработана запись (в Crack — подобранный)
+    int id;
+    string status;
+    string message;
+};
+
+/**
+ * @brief Результат одного рабочего потока: вывод и логи его диапазона записей
+ */
+struct WorkerOutput {
+    ostringstream console;
+    vector<PendingLog> logs;
+    int successCount = 0;
+    size_t contentBytes = 0;    // Объём обработанного текста (для --stats)
+};
+
+/**
+ * @brief Количество рабочих потоков пакетной обработки
+ *
+ * 0 — по числу аппаратных потоков (std::thread::hardware_concurrency).
+ */
+unsigned getWorkerCount(size_t recordCount) {
+    unsigned workers = threadCount;
+    if (workers == 0) {
+        workers = thread::hardware_concurrency();
+    }
+    if (workers == 0) {
+        workers = 1;
+    }
+    if (workers > recordCount) {
+        workers = static_cast<unsigned>(recordCount);
+    }
+    return workers;
+}
+
+/**
+ * @brief Делит [0, count) на непрерывные диапазоны и обрабатывает их в потоках
+ *
+ * Диапазон i достаётся потоку i, поэтому результаты, собранные по порядку
+ * потоков, идут в порядке записей. Первый диапазон выполняется в вызывающем потоке.
+ */
+void runParallel(size_t count, unsigned workers,
+                 const function<void(size_t begin, size_t end, unsigned worker)>& body) {
+    size_t chunk = (count + workers - 1) / workers;
+    vector<thread> pool;
+    pool.reserve(workers - 1);
+    
+    for (unsigned worker = 1; worker < workers; worker++) {
+        size_t begin = min(count, worker * chunk);
+        size_t end = min(count, begin + chunk);
+        pool.emplace_back(body, begin, end, worker);
+    }
+    body(0, min(count, chunk), 0);
+    
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Записывает результат обработки записи в лог
+ *
+ * Асинхронный логгер принимает записи из любого потока напрямую;
+ * иначе запись откладывается в out до слияния в вызывающем потоке.
+ */
+void logResult(WorkerOutput& out, const string& operation, int key, int id,
+               const string& status, const string& message) {
+    if (logger.isAsync()) {
+        logger.log(operation, key, id, status, message);
+    } else {
+        out.logs.push_back({key, id, status, message});
+    }
+}
+
+/**
+ * @brief Шифрует одну запись; вывод и логи складываются в out
+ *
+ * Из записи разбираются только поля content и id, остальные при
+ * записи копируются как есть. В режиме Crack ключ подбирается для
+ * каждой записи; lang == 0 — язык выбирается по тексту.
+ */
+void processRecord(JsonLazyObject& record, int key, char lang,
+                   CipherMode mode, const string& operation, WorkerOutput& out) {
+    int recordId = -1;
+    try {
+        // Строка без экранирования не копируется: это срез входного текста
+        JsonValue contentValue;
+        if (!record.get("content", contentValue)) {
+            out.console << "⚠ Пропущена запись без поля 'content'\n";
+            return;
+        }
+        string convertedContent;
+        string_view originalContent = contentValue.type() == JsonType::String ?
+                                      contentValue.asStringView() :
+                                      string_view(convertedContent = contentValue.asString());
+        
+        JsonValue idValue;
+        if (record.get("id", idValue) && idValue.type() == JsonType::Number) {
+            recordId = static_cast<int>(idValue.asNumber());
+        }
+        
+        // Ключ подбирается по гистограмме за один проход, расшифровка —
+        // только найденным ключом
+        if (mode == CipherMode::Crack) {
+            CaesarCrackResult found = findCaesarKey(originalContent, lang);
+            key = found.key;
+            lang = found.lang;
+        }
+        
+        // Единственная аллокация — буфер результата, шифр сам память не выделяет
+        string processedContent(originalContent.size(), '\0');
+        out.contentBytes += originalContent.size();
+        
+        if (mode == CipherMode::Encrypt) {
+            encryptCaesar(originalContent, &processedContent[0], key, lang);
+        } else if (key == 0) {
+            // Подбор ключа: текст не сдвинут
+            copy(originalContent.begin(), originalContent.end(), processedContent.begin());
+        } else {
+            decryptCaesar(originalContent, &processedContent[0], key, lang);
+        }
+        
+        // Логируем операцию
+        logResult(out, operation, key, recordId, "успешно", "");
+        
+        // Выводим результат (в тихом режиме превью не формируется вовсе)
+        if (!quietMode) {
+            string_view processedPreview(processedContent);
+            out.console << "ID " << recordId << ": " << originalContent.substr(0, 50);
+            if (originalContent.length() > 50) out.console << "...";
+            out.console << "\n  → " << processedPreview.substr(0, 50);
+            if (processedContent.length() > 50) out.console << "...";
+            out.console << "\n";
+        }
+        
+        record.reserve(4);
+        record.insert_or_assign("key_used", JsonValue(static_cast<double>(key)));
+        record.insert_or_assign("operation", JsonValue(operation));
+        if (mode == CipherMode::Crack) {
+            record.insert_or_assign("detected_lang", JsonValue(string(1, lang)));
+        }
+        record.insert_or_assign("processed_content", JsonValue(move(processedContent)));
+        
+        out.successCount++;
+    } catch (const exception& e) {
+        out.console << "✗ Ошибка: " << e.what() << "\n";
+        logResult(out, operation, key, recordId, "ошибка", e.what());
+    }
+}
+
+/**
+ * @brief Разбирает список --ids ("1,3,5")
+ *
+ * @return false, если список пуст или содержит не целое число
+ */
+bool parseIdList(const string& idsStr, vector<int>& ids) {
+    stringstream list(idsStr);
+    string item;
+    while (getline(list, item, ',')) {
+        try {
+            size_t used = 0;
+            ids.push_back(stoi(item, &used));
+            if (used != item.size()) return false;
+        } catch (...) {
+            return false;
+        }
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    return !ids.empty();
+}
+
+/**
+ * @brief Позиции записей с указанными id по recordIndex, по возрастанию
+ *
+ * О каждом отсутствующем id выводится предупреждение.
+ */
+vector<size_t> selectRecords(const vector<int>& ids) {
+    vector<size_t> selection;
+    for (int id : ids) {
+        auto range = recordIndex.equal_range(id);
+        if (range.first == range.second) {
+            cout << "⚠ ID не найден: " << id << "\n";
+        }
+        for (auto it = range.first; it != range.second; ++it) {
+            selection.push_back(it->second);
+        }
+    }
+    sort(selection.begin(), selection.end());
+    selection.erase(unique(selection.begin(), selection.end()), selection.end());
+    return selection;
+}
+
+/**
+ * @brief Обрабатывает currentData или только записи из selection
+ *
+ * Остальные записи не меняются.
+ */
+void processEncryption(int key, char lang, CipherMode mode, const vector<size_t>* selection = nullptr) {
     if (currentData.empty()) {
         cout << "✗ Сначала загрузите данные (пункт 1)\n";
         return;
     }
     
-    string operation = isEncryption ? "encrypt" : "decrypt";
-    string operationRu = isEncryption ? "Шифрование" : "Расшифрование";
+    string operation = operationName(mode);
     
-    cout << "\n" << operationRu << " (ключ = " << key << "):\n";
-    cout << "─────────────────────────────────────────────────────────────\n";
+    cout << "\n" << operationTitle(mode, key) << "):\n";
+    if (!quietMode) cout << "─────────────────────────────────────────────────────────────\n";
     
+    // Записи делятся между потоками; cout и синхронный logger трогает
+    // только вызывающий поток при слиянии (асинхронному пишут сами потоки)
+    size_t count = selection ? selection->size() : currentData.size();
+    unsigned workers = max(1u, getWorkerCount(count));
+    vector<WorkerOutput> outputs(workers);
+    
+    {
+        StageTimer stage("process");
+        runParallel(count, workers,
+                    [&](size_t begin, size_t end, unsigned worker) {
+            for (size_t i = begin; i < end; i++) {
+                JsonLazyObject& record = currentData[selection ? (*selection)[i] : i];
+                processRecord(record, key, lang, mode, operation, outputs[worker]);
+            }
+        });
+        stage.addRecords(count);
+        for (const auto& out : outputs) {
+            stage.addBytes(out.contentBytes);
+        }
+    }
+    
+    // Слияние в порядке записей
     int successCount = 0;
+    for (auto& out : outputs) {
+        {
+            StageTimer stage("print");
+            string console = out.console.str();
+            cout << console;
+            stage.addBytes(console.size());
+        }
+        StageTimer stage("log");
+        for (const auto& entry : out.logs) {
+            logger.log(operation, entry.key, entry.id, entry.status, entry.message);
+        }
+        stage.addRecords(out.logs.size());
+        successCount += out.successCount;
+    }
+    {
+        StageTimer stage("log");
+        logger.saveToFile();
+    }
+    
+    if (!quietMode) cout << "─────────────────────────────────────────────────────────────\n";
+    cout << "✓ Обработано " << successCount << " из " << count << " записей\n";
+    if (selection) {
+        cout << "  Без изменений: " << currentData.size() - count << " записей\n";
+    }
+}
+
+/**
+ * @brief Потоковая обработка: запись читается, шифруется и сразу пишется
+ *
+ * Документ целиком в память не загружается: в каждый момент хранится
+ * только текущая запись, поэтому пиковая память — O(размер записи).
+ * Файл результата пишется рядом и подменяет целевой только при успехе,
+ * как в saveResults.
+ */
+bool processStream(const string& inputFile, const string& outputFile,
+                   int key, char lang, CipherMode mode, const vector<int>* ids = nullptr) {
+    // Вход читается во время записи выхода, поэтому это должны быть разные файлы
+    if (inputFile != "-" && outputFile != "-") {
+        error_code error;
+        if (filesystem::equivalent(inputFile, outputFile, error)) {
+            cout << "✗ В потоковом режиме выходной файл должен отличаться от входного: "
+                 << outputFile << "\n";
+            return false;
+        }
+    }
+    
+    // "-" — stdin и stdout: так режим встаёт в конвейер оболочки
+    ifstream fileInput;
+    if (inputFile == "-") {
+        setBinaryMode(stdin);
+    } else {
+        fileInput.open(inputFile, ios::binary);
+        if (!fileInput.is_open()) {
+            cout << "✗ Ошибка при загрузке файла: Не удалось открыть файл: " << inputFile << "\n";
+            return false;
+        }
+    }
+    istream& input = inputFile == "-" ? cin : fileInput;
     
-    for (auto& record : currentData) {
-        if (record.find("content") == record.end()) {
-            cout << "⚠ Пропущена запись без поля 'content'\n";
-            continue;
+    ofstream fileOutput;
+    string tempName = outputFile + ".tmp";
+    if (outputFile != "-") {
+        fileOutput.open(tempName, ios::binary);
+        if (!fileOutput.is_open()) {
+            cout << " Ошибка при сохранении: Не удалось создать файл: " << outputFile << "\n";
+            return false;
         }
+    }
+    ostream stdoutOutput(stdoutBuffer);
+    ostream& output = outputFile == "-" ? stdoutOutput : fileOutput;
+    
+    string operation = operationName(mode);
+    
+    cout << "\n" << operationTitle(mode, key) << ", потоковый режим):\n";
+    if (!quietMode) cout << "─────────────────────────────────────────────────────────────\n";
+    
+    size_t recordCount = 0;
+    size_t passedCount = 0;
+    int successCount = 0;
+    
+    // Запись не разбирается целиком: из неё читаются только content и id,
+    // а с --ids у невыбранной записи — только id, и она пишется как есть
+    unordered_set<int> selectedIds, foundIds;
+    if (ids) {
+        selectedIds.insert(ids->begin(), ids->end());
+    }
+    
+    try {
+        JsonArrayReader reader(input);
+        JsonArrayWriter writer(output, true);
+        string_view text;
+        JsonValue id;
         
-        try {
-            string originalContent = record["content"].asString();
-            string processedContent;
-            
-            if (isEncryption) {
-                processedContent = encryptCaesar(originalContent, key, lang);
-            } else {
-                processedContent = decryptCaesar(originalContent, key, lang);
+        // Этапы чередуются по записям; --stats суммирует их по всем записям.
+        // Прочитанные байты — по позиции во входном файле (у конца файла
+        // tellg() не работает, тогда позиция — размер файла; у канала
+        // позиции нет вовсе)
+        uintmax_t inputSize = 0, inputPos = 0;
+        if (statsEnabled() && inputFile != "-") {
+            error_code error;
+            inputSize = filesystem::file_size(inputFile, error);
+        }
+        while (true) {
+            {
+                StageTimer stage("stream_read");
+                bool hasItem = reader.nextText(text);
+                if (statsEnabled()) {
+                    streamoff pos = input.tellg();
+                    uintmax_t current = pos >= 0 ? static_cast<uintmax_t>(pos) : max(inputSize, inputPos);
+                    stage.addBytes(current - inputPos);
+                    inputPos = current;
+                }
+                if (!hasItem) break;
             }
+            if (text[0] != '{') {
+                continue;  // Как и в loadJsonData, учитываются только объекты
+            }
+            JsonLazyObject record(text);
+            if (ids) {
+                if (!record.get("id", id) || id.type() != JsonType::Number ||
+                    !selectedIds.count(static_cast<int>(id.asNumber()))) {
+                    StageTimer stage("stream_write");
+                    writer.writeRaw(text);
+                    stage.addBytes(text.size());
+                    passedCount++;
+                    continue;
+                }
+                foundIds.insert(static_cast<int>(id.asNumber()));
+            }
+            recordCount++;
             
-            int recordId = record["id"].type == JsonType::Number ? 
-                          static_cast<int>(record["id"].asNumber()) : -1;
-            
-            // Обновляем запись
-            record["processed_content"] = JsonValue(processedContent);
-            record["key_used"] = JsonValue(static_cast<double>(key));
-            record["operation"] = JsonValue(operation);
-            
-            // Логируем операцию\n            logger.log(operation, key, recordId, "успешно", "");
-            
-            // Выводим результат
-            cout << "ID " << recordId << ": " << originalContent.substr(0, 50);
-            if (originalContent.length() > 50) cout << "...";
-            cout << "\n  → " << processedContent.substr(0, 50);
-            if (processedContent.length() > 50) cout << "...";
-            cout << "\n";
+            WorkerOutput out;
+            {
+                StageTimer stage("process");
+                processRecord(record, key, lang, mode, operation, out);
+                stage.addRecords(1);
+                stage.addBytes(out.contentBytes);
+            }
+            {
+                StageTimer stage("print");
+                string console = out.console.str();
+                cout << console;
+                stage.addBytes(console.size());
+            }
+            {
+                StageTimer stage("log");
+                for (const auto& entry : out.logs) {
+                    logger.log(operation, entry.key, entry.id, entry.status, entry.message);
+                }
+                stage.addRecords(out.logs.size());
+            }
+            successCount += out.successCount;
             
-            successCount++;
-        } catch (const exception& e) {
-            cout << "✗ Ошибка: " << e.what() << "\n";
-            logger.log(operation, key, -1, "ошибка", e.what());
+            StageTimer stage("stream_write");
+            streamoff before = statsEnabled() ? streamoff(output.tellp()) : 0;
+            writer.write(record);
+            stage.addRecords(1);
+            if (statsEnabled()) {
+                stage.addBytes(static_cast<uint64_t>(streamoff(output.tellp()) - before));
+            }
         }
+        
+        StageTimer stage("stream_write");
+        streamoff before = statsEnabled() ? streamoff(output.tellp()) : 0;
+        writer.finish();
+        output.flush();
+        if (statsEnabled()) {
+            stage.addBytes(static_cast<uint64_t>(streamoff(output.tellp()) - before));
+        }
+        if (!output) {
+            throw runtime_error("Ошибка записи в файл: " + displayName(outputFile, "stdout"));
+        }
+        if (outputFile != "-") {
+            fileOutput.close();
+            error_code error;
+            filesystem::rename(tempName, outputFile, error);
+            if (error) {
+                throw runtime_error("Ошибка записи в файл: " + outputFile);
+            }
+        }
+    } catch (const exception& e) {
+        // Недописанный результат не подменяет целевой файл
+        if (outputFile != "-") {
+            fileOutput.close();
+            error_code error;
+            filesystem::remove(tempName, error);
+        }
+        logger.saveToFile();
+        cout << "✗ Ошибка потоковой обработки: " << e.what() << "\n";
+        return false;
+    }
+    {
+        StageTimer stage("log");
+        logger.saveToFile();
     }
     
-    cout << "─────────────────────────────────────────────────────────────\n";
-    cout << "✓ Обработано " << successCount << " из " << currentData.size() << " записей\n";
+    if (!quietMode) cout << "─────────────────────────────────────────────────────────────\n";
+    if (ids) {
+        for (int id : *ids) {
+            if (!foundIds.count(id)) {
+                cout << "⚠ ID не найден: " << id << "\n";
+                foundIds.insert(id);   // Повтор в списке — одно предупреждение
+            }
+        }
+    }
+    cout << "✓ Обработано " << successCount << " из " << recordCount << " записей\n";
+    if (ids) {
+        cout << "  Без изменений: " << passedCount << " записей\n";
+    }
+    cout << " Результаты сохранены в " << displayName(outputFile, "stdout") << "\n";
+    return true;
+}
+
+/**
+ * @brief Выборка из лога по id, операции и интервалу времени
+ *
+ * Запрос выполняется по бинарному сегменту рядом с логом (logFile + ".seg"),
+ * который пересобирается, только если лог изменился после его создания.
+ */
+bool queryLog(const string& logFile, const LogQuery& query) {
+    try {
+        size_t rebuilt = 0, total = 0;
+        vector<LogEntry> found = queryLogHistory(logFile, query, rebuilt, total);
+        if (rebuilt > 0) {
+            cout << "✓ Обновлено индексов лога: " << rebuilt << "\n";
+        }
+        printLogEntries(found, true);
+        cout << "Записей в логе: " << total << "\n";
+        return true;
+    } catch (const exception& e) {
+        cout << "✗ Ошибка запроса к логу: " << e.what() << "\n";
+        return false;
+    }
+}
+
+/**
+ * @brief Пишет currentData массивом JSON — по записи, без сборки JsonArray
+ */
+void writeRecords(ostream& out) {
+    JsonArrayWriter writer(out, true);
+    for (const auto& record : currentData) {
+        writer.write(record);
+    }
+    writer.finish();
+    out.flush();
+}
+
+/**
+ * @brief Сохраняет currentData в файл или в stdout ("-")
+ *
+ * Файл пишется рядом и подменяет целевой: записи ссылаются на
+ * отображённый в память входной файл, который может совпадать с выходным.
+ */
+bool saveResults(const string& filename) {
+    try {
+        StageTimer stage("save_json");
+        stage.addRecords(currentData.size());
+        if (filename == "-") {
+            ostream out(stdoutBuffer ? stdoutBuffer : cout.rdbuf());
+            writeRecords(out);
+            if (!out) {
+                throw runtime_error("Ошибка записи в stdout");
+            }
+        } else {
+            string tempName = filename + ".tmp";
+            {
+                ofstream out(tempName, ios::binary);
+                if (!out.is_open()) {
+                    throw runtime_error("Не удалось создать файл: " + filename);
+                }
+                writeRecords(out);
+                if (!out) {
+                    throw runtime_error("Ошибка записи в файл: " + filename);
+                }
+            }
+            error_code error;
+            filesystem::rename(tempName, filename, error);
+            if (error) {
+                filesystem::remove(tempName, error);
+                throw runtime_error("Ошибка записи в файл: " + filename);
+            }
+            if (statsEnabled()) {
+                stage.addBytes(filesystem::file_size(filename, error));
+            }
+        }
+        cout << " Результаты сохранены в " << displayName(filename, "stdout") << "\n";
+        return true;
+    } catch (const exception& e) {
+        cout << " Ошибка при сохранении: " << e.what() << "\n";
+        return false;
+    }
 }
 
-void saveResults() {
+/**
+ * @brief Пункт меню «Сохранить результаты»: спрашивает имя файла
+ */
+void promptSaveResults() {
     if (currentData.empty()) {
         cout << "✗ Нет данных для сохранения\n";
         return;
@@ -186,27 +824,7 @@ void saveResults() {
     if (filename.empty()) {
         filename = "output.json";
     }
-    
-    try {
-        JsonValue arr;
-        arr.type = JsonType::Array;
-        
-        for (const auto& record : currentData) {
-            JsonValue obj;
-            obj.type = JsonType::Object;
-            
-            for (const auto& [key, value] : record) {
-                obj.objectValue[key] = value;
-            }
-            
-            arr.arrayValue.push_back(obj);
-        }
-        
-        saveJsonFile(filename, arr, true);
-        cout << " Результаты сохранены в " << filename << "\n";
-    } catch (const exception& e) {
-        cout << " Ошибка при сохранении: " << e.what() << "\n";
-    }
+    saveResults(filename);
 }
 
 void interactiveMenu() {
@@ -219,14 +837,9 @@ void interactiveMenu() {
         getline(cin, choice);
         
         if (choice == "0") {
-            cout << "\nСохранить логи перед выходом? (y/n): ";
-            string answer;
-            getline(cin, answer);
-            
-            if (answer == "y" || answer == "Y") {
-                if (logger.saveToFile()) {
-                    cout << "✓ Логи сохранены\n";
-                }
+            // Записи лога дописываются в файл по ходу работы
+            if (logger.saveToFile() && logger.size() > 0) {
+                cout << "✓ Логи сохранены\n";
             }
             
             cout << "\nДо свидания!\n\n";
@@ -276,7 +889,7 @@ void interactiveMenu() {
                 continue;
             }
             
-            processEncryption(key, lang[0], true);
+            processEncryption(key, lang[0], CipherMode::Encrypt);
         } else if (choice == "3") {
             if (currentData.empty()) {
                 cout << "✗ Сначала загрузите данные\n";
@@ -309,22 +922,278 @@ void interactiveMenu() {
                 continue;
             }
             
-            processEncryption(key, lang[0], false);
+            processEncryption(key, lang[0], CipherMode::Decrypt);
         } else if (choice == "4") {
+            // История читается из файла только по запросу
+            logger.loadFromFile();
             logger.printToConsole();
         } else if (choice == "5") {
-            saveResults();
+            promptSaveResults();
+        } else if (choice == "6") {
+            // Язык каждой записи определяется по её тексту
+            processEncryption(0, 0, CipherMode::Crack);
         } else {
             cout << "✗ Некорректный выбор. Попробуйте снова.\n";
         }
     }
 }
 
+// === Пакетные задания (--jobs) ===
+
+/**
+ * @brief Одно задание манифеста: файл, режим, ключ и язык
+ */
+struct BatchJob {
+    string input;
+    string output;
+    CipherMode mode = CipherMode::Encrypt;
+    int key = 0;
+    char lang = 'E';        // В режиме Crack 0 — язык определяется по тексту
+};
+
+/**
+ * @brief Итог задания; заполняет поток пула, читает главный поток
+ */
+struct BatchJobResult {
+    bool ok = false;
+    size_t records = 0;
+    int successCount = 0;
+    uint64_t contentBytes = 0;
+    string error;
+    string console;         // Превью записей (если не тихий режим)
+};
+
+/**
+ * @brief Читает манифест заданий
+ *
+ * Манифест — массив заданий или объект {"jobs": [...]}. Задание:
+ * {"input": FILE, "output": FILE, "mode": "enc"|"dec"|"crack",
+ *  "key": N или "random", "lang": "E"|"R"}. Относительные пути
+ * отсчитываются от каталога манифеста. Задания проверяются все сразу,
+ * до начала обработки.
+ *
+ * @throw std::runtime_error с номером задания, если манифест некорректен
+ */
+vector<BatchJob> loadJobManifest(const string& manifestFile) {
+    JsonValue manifest = loadJsonFile(manifestFile);
+    const JsonValue* list = &manifest;
+    if (manifest.type() == JsonType::Object) {
+        auto it = manifest.asObject().find("jobs");
+        if (it == manifest.asObject().end()) {
+            throw runtime_error("в манифесте нет поля 'jobs'");
+        }
+        list = &it->second;
+    }
+    if (list->type() != JsonType::Array) {
+        throw runtime_error("задания должны быть массивом");
+    }
+    
+    filesystem::path base = filesystem::path(manifestFile).parent_path();
+    vector<BatchJob> jobs;
+    vector<string> outputs;
+    for (const auto& item : list->asArray()) {
+        string where = "задание " + to_string(jobs.size() + 1) + ": ";
+        if (item.type() != JsonType::Object) {
+            throw runtime_error(where + "ожидается объект");
+        }
+        const JsonObject& fields = item.asObject();
+        auto text = [&](const char* name, const string& fallback) {
+            auto it = fields.find(name);
+            if (it == fields.end()) {
+                if (!fallback.empty()) return fallback;
+                throw runtime_error(where + "нет поля '" + name + "'");
+            }
+            if (it->second.type() != JsonType::String || it->second.asStringView().empty()) {
+                throw runtime_error(where + "поле '" + name + "' должно быть непустой строкой");
+            }
+            return it->second.asString();
+        };
+        
+        BatchJob job;
+        job.input = (base / text("input", "")).string();
+        job.output = (base / text("output", "")).string();
+        
+        string mode = text("mode", "");
+        if (mode == "enc") job.mode = CipherMode::Encrypt;
+        else if (mode == "dec") job.mode = CipherMode::Decrypt;
+        else if (mode == "crack") job.mode = CipherMode::Crack;
+        else throw runtime_error(where + "режим должен быть 'enc', 'dec' или 'crack'");
+        
+        bool langSet = fields.find("lang") != fields.end();
+        string lang = text("lang", "E");
+        job.lang = static_cast<char>(toupper(lang[0]));
+        if (lang.size() != 1 || getAlphabetSize(job.lang) == 0) {
+            throw runtime_error(where + "язык должен быть E или R");
+        }
+        
+        auto keyIt = fields.find("key");
+        if (job.mode == CipherMode::Crack) {
+            if (!langSet) job.lang = 0;
+        } else if (keyIt == fields.end()) {
+            throw runtime_error(where + "нет поля 'key'");
+        } else if (keyIt->second.type() == JsonType::String && keyIt->second.asStringView() == "random") {
+            job.key = generateRandomKey(job.lang);
+        } else if (keyIt->second.type() == JsonType::Number) {
+            job.key = static_cast<int>(keyIt->second.asNumber());
+            if (job.key != keyIt->second.asNumber() || !isValidKey(job.key, job.lang)) {
+                throw runtime_error(where + getKeyRangeError(job.lang));
+            }
+        } else {
+            throw runtime_error(where + "ключ должен быть числом или \"random\"");
+        }
+        
+        // Два задания с одним выходным файлом перезаписали бы друг друга
+        if (find(outputs.begin(), outputs.end(), job.output) != outputs.end()) {
+            throw runtime_error(where + "выходной файл уже указан в другом задании: " + job.output);
+        }
+        outputs.push_back(job.output);
+        jobs.push_back(move(job));
+    }
+    return jobs;
+}
+
+/**
+ * @brief Выполняет одно задание в текущем потоке
+ *
+ * Записи обрабатываются по порядку и сразу пишутся в файл рядом с
+ * выходным, который затем его подменяет. Лог должен быть асинхронным:
+ * processRecord пишет в него из потоков пула напрямую.
+ */
+void runJob(const BatchJob& job, BatchJobResult& result) {
+    try {
+        JsonDocument document(job.input, JsonParseMode::OnDemand);
+        vector<string_view> elements;
+        if (!splitJsonArray(document.text(), elements)) {
+            throw runtime_error("входной файл должен содержать массив записей");
+        }
+        
+        string operation = operationName(job.mode);
+        string tempName = job.output + ".tmp";
+        WorkerOutput out;
+        {
+            ofstream output(tempName, ios::binary);
+            if (!output.is_open()) {
+                throw runtime_error("Не удалось создать файл: " + job.output);
+            }
+            JsonArrayWriter writer(output, true);
+            for (string_view element : elements) {
+                if (element[0] != '{') {
+                    continue;  // Как и в loadJsonData, учитываются только объекты
+                }
+                JsonLazyObject record(element);
+                processRecord(record, job.key, job.lang, job.mode, operation, out);
+                writer.write(record);
+                result.records++;
+            }
+            writer.finish();
+            if (!output.flush()) {
+                throw runtime_error("Ошибка записи в файл: " + job.output);
+            }
+        }
+        error_code error;
+        filesystem::rename(tempName, job.output, error);
+        if (error) {
+            filesystem::remove(tempName, error);
+            throw runtime_error("Ошибка записи в файл: " + job.output);
+        }
+        
+        result.successCount = out.successCount;
+        result.contentBytes = out.contentBytes;
+        result.console = out.console.str();
+        result.ok = true;
+    } catch (const exception& e) {
+        result.error = e.what();
+    }
+}
+
+/**
+ * @brief Выполняет задания манифеста в пуле потоков
+ *
+ * Поток пула берёт следующее задание, как только закончил предыдущее,
+ * поэтому файлы разного размера распределяются сами. Таблицы шифра
+ * общие для всех заданий, а лог пишет один фоновый писатель. Итоги
+ * выводятся в порядке заданий.
+ *
+ * @return true, если все задания выполнены
+ */
+bool processJobs(const string& manifestFile) {
+    vector<BatchJob> jobs;
+    try {
+        jobs = loadJobManifest(manifestFile);
+    } catch (const exception& e) {
+        cout << "✗ Ошибка в манифесте " << manifestFile << ": " << e.what() << "\n";
+        return false;
+    }
+    
+    unsigned workers = getWorkerCount(jobs.size());
+    cout << "Заданий: " << jobs.size() << ", потоков: " << workers << "\n";
+    
+    // Потоки пула пишут в лог напрямую, через lock-free очередь
+    logger.startAsync();
+    
+    vector<BatchJobResult> results(jobs.size());
+    auto started = chrono::steady_clock::now();
+    {
+        StageTimer stage("jobs");
+        atomic<size_t> nextJob{0};
+        auto worker = [&]() {
+            for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+                runJob(jobs[i], results[i]);
+            }
+        };
+        vector<thread> pool;
+        for (unsigned i = 1; i < workers; i++) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto& t : pool) {
+            t.join();
+        }
+        for (const auto& result : results) {
+            stage.addRecords(result.records);
+            stage.addBytes(result.contentBytes);
+        }
+    }
+    {
+        StageTimer stage("log");
+        logger.saveToFile();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    
+    size_t done = 0, records = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const BatchJobResult& result = results[i];
+        cout << result.console;
+        if (result.ok) {
+            done++;
+            records += result.records;
+            if (!quietMode) {
+                cout << "✓ " << jobs[i].input << " → " << jobs[i].output << ": " << result.successCount
+                     << " из " << result.records << " записей\n";
+            }
+        } else {
+            cout << "✗ " << jobs[i].input << ": " << result.error << "\n";
+        }
+    }
+    cout << "✓ Выполнено заданий: " << done << " из " << jobs.size() << ", записей: " << records
+         << ", за " << fixed << setprecision(2) << seconds << " с\n";
+    return done == jobs.size();
+}
+
 // === Обработка аргументов командной строки ===
 
-void processCLI(int argc, char* argv[]) {
-    string mode, inputFile, outputFile, keyStr, idsStr;
+bool processCLI(int argc, char* argv[]) {
+    string mode, inputFile, outputFile, keyStr, idsStr, threadsStr, jobsFile;
+    bool streamMode = false;
+    bool asyncLog = false;
+    bool verbositySet = false;
+    bool logQueryMode = false;
+    string logFile = "data/operations.log", queryIdStr, fromStr, toStr;
+    LogQuery query;
+    string maxSizeStr, maxAgeStr, keepStr;
+    bool compressLog = false;
     char lang = 'E';
+    bool langSet = false;
     int key = -1;
     
     for (int i = 1; i < argc; i++) {
@@ -332,7 +1201,7 @@ void processCLI(int argc, char* argv[]) {
         
         if (arg == "--help") {
             printHelp();
-            return;
+            return true;
         } else if (arg == "--mode" && i + 1 < argc) {
             mode = argv[++i];
         } else if (arg == "--key" && i + 1 < argc) {
@@ -345,28 +1214,144 @@ void processCLI(int argc, char* argv[]) {
             idsStr = argv[++i];
         } else if (arg == "--lang" && i + 1 < argc) {
             lang = argv[++i][0];
+            langSet = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadsStr = argv[++i];
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            jobsFile = argv[++i];
+        } else if (arg == "--stream") {
+            streamMode = true;
+        } else if (arg == "--async-log") {
+            asyncLog = true;
+        } else if (arg == "--quiet") {
+            quietMode = true;
+            verbositySet = true;
+        } else if (arg == "--verbose") {
+            quietMode = false;
+            verbositySet = true;
+        } else if (arg == "--stats") {
+            enableStats();
+        } else if (arg == "--stats-json" && i + 1 < argc) {
+            statsJsonFile = argv[++i];
+            enableStats();
+        } else if (arg == "--log-query") {
+            logQueryMode = true;
+        } else if (arg == "--log-file" && i + 1 < argc) {
+            logFile = argv[++i];
+        } else if (arg == "--id" && i + 1 < argc) {
+            queryIdStr = argv[++i];
+        } else if (arg == "--operation" && i + 1 < argc) {
+            query.operation = argv[++i];
+        } else if (arg == "--from" && i + 1 < argc) {
+            fromStr = argv[++i];
+        } else if (arg == "--to" && i + 1 < argc) {
+            toStr = argv[++i];
+        } else if (arg == "--log-max-size" && i + 1 < argc) {
+            maxSizeStr = argv[++i];
+        } else if (arg == "--log-max-age" && i + 1 < argc) {
+            maxAgeStr = argv[++i];
+        } else if (arg == "--log-compress") {
+            compressLog = true;
+        } else if (arg == "--log-keep" && i + 1 < argc) {
+            keepStr = argv[++i];
         }
     }
     
+    if (logQueryMode) {
+        if (!queryIdStr.empty()) {
+            try {
+                query.id = stoi(queryIdStr);
+            } catch (...) {
+                cout << "✗ Некорректный ID: " << queryIdStr << "\n";
+                return false;
+            }
+        }
+        if (!fromStr.empty() && !parseTimestamp(fromStr, query.fromNs)) {
+            cout << "✗ Время должно быть в формате YYYY-MM-DDTHH:MM:SS: " << fromStr << "\n";
+            return false;
+        }
+        if (!toStr.empty()) {
+            if (!parseTimestamp(toStr, query.toNs)) {
+                cout << "✗ Время должно быть в формате YYYY-MM-DDTHH:MM:SS: " << toStr << "\n";
+                return false;
+            }
+            query.toNs += 1000000000;  // Включая всю указанную секунду
+        }
+        return queryLog(logFile, query);
+    }
+    
+    if (!threadsStr.empty()) {
+        try {
+            int threads = stoi(threadsStr);
+            if (threads < 1) throw invalid_argument(threadsStr);
+            threadCount = static_cast<unsigned>(threads);
+        } catch (...) {
+            cout << "✗ Число потоков должно быть положительным целым\n";
+            return false;
+        }
+    }
+    
+    LogRotationOptions rotation;
+    rotation.compress = compressLog;
+    try {
+        if (!maxSizeStr.empty()) rotation.maxBytes = stoull(maxSizeStr);
+        if (!maxAgeStr.empty()) rotation.maxAge = chrono::seconds(stoll(maxAgeStr));
+        if (!keepStr.empty()) rotation.maxSegments = stoull(keepStr);
+        if (rotation.maxAge.count() < 0) throw invalid_argument(maxAgeStr);
+    } catch (...) {
+        cout << "✗ Пороги ротации лога должны быть неотрицательными целыми\n";
+        return false;
+    }
+    logger.setRotation(rotation);
+    
+    if (!jobsFile.empty()) {
+        return processJobs(jobsFile);
+    }
+    
+    vector<int> ids;
+    if (!idsStr.empty() && !parseIdList(idsStr, ids)) {
+        cout << "✗ ID должны быть целыми числами через запятую: " << idsStr << "\n";
+        return false;
+    }
+    
     // Валидация параметров
     if (mode.empty() || inputFile.empty() || outputFile.empty()) {
         cout << "✗ Требуются параметры: --mode, --input, --output\n";
         cout << "Используйте --help для справки\n";
-        return;
+        return false;
     }
     
-    if (mode != "enc" && mode != "dec") {
-        cout << "✗ Режим должен быть 'enc' или 'dec'\n";
-        return;
+    // С --output - все сообщения уходят в stderr, и превью по умолчанию
+    // зависят уже от него
+    if (outputFile == "-") {
+        reserveStdoutForResults();
+        if (!verbositySet) {
+            quietMode = !isTerminal(stderr);
+        }
+    }
+    if (inputFile == "-") {
+        cin.tie(nullptr);   // stdin — данные, а не ответы на вопросы
     }
     
-    if (keyStr.empty()) {
-        cout << "✗ Требуется параметр --key\n";
-        return;
+    if (mode != "enc" && mode != "dec" && mode != "crack") {
+        cout << "✗ Режим должен быть 'enc', 'dec' или 'crack'\n";
+        return false;
     }
+    CipherMode cipherMode = mode == "enc" ? CipherMode::Encrypt :
+                            mode == "dec" ? CipherMode::Decrypt : CipherMode::Crack;
     
-    // Парсинг ключа
-    if (keyStr == "random") {
+    if (cipherMode == CipherMode::Crack) {
+        // Ключ подбирается; без --lang язык определяется по тексту записи
+        if (langSet && getAlphabetSize(lang) == 0) {
+            cout << "✗ Язык должен быть E или R\n";
+            return false;
+        }
+        lang = langSet ? static_cast<char>(toupper(lang)) : 0;
+        key = 0;
+    } else if (keyStr.empty()) {
+        cout << "✗ Требуется параметр --key\n";
+        return false;
+    } else if (keyStr == "random") {
         key = generateRandomKey(lang);
         cout << "Сгенерирован случайный ключ: " << key << "\n";
     } else {
@@ -374,35 +1359,79 @@ void processCLI(int argc, char* argv[]) {
             key = stoi(keyStr);
         } catch (...) {
             cout << "✗ Некорректный ключ\n";
-            return;
+            return false;
         }
     }
     
-    if (!isValidKey(key, lang)) {
+    if (cipherMode != CipherMode::Crack && !isValidKey(key, lang)) {
         cout << "✗ " << getKeyRangeError(lang) << "\n";
-        return;
+        return false;
     }
     
-    // Обработка файлов
-    if (!loadJsonData(inputFile)) {
-        return;
+    if (asyncLog) {
+        logger.startAsync();
+    }
+    
+    if (streamMode) {
+        return processStream(inputFile, outputFile, key, lang, cipherMode, ids.empty() ? nullptr : &ids);
     }
     
-    bool isEncryption = (mode == "enc");
-    processEncryption(key, lang, isEncryption);
-    saveResults();
+    // Обработка файлов; вопросов не задаётся — результат идёт в --output
+    if (!loadJsonData(inputFile, !ids.empty())) {
+        return false;
+    }
+    
+    if (ids.empty()) {
+        processEncryption(key, lang, cipherMode);
+    } else {
+        vector<size_t> selection = selectRecords(ids);
+        processEncryption(key, lang, cipherMode, &selection);
+    }
+    return saveResults(outputFile);
+}
+
+/**
+ * @brief Выводит статистику этапов (--stats) в stderr или в --stats-json
+ */
+void reportStats() {
+    if (!statsEnabled()) return;
+    
+    if (statsJsonFile.empty()) {
+        printStats();
+        return;
+    }
+    try {
+        saveStatsJson(statsJsonFile);
+        cout << "✓ Статистика сохранена в " << statsJsonFile << "\n";
+    } catch (const exception& e) {
+        cout << "✗ Ошибка при сохранении статистики: " << e.what() << "\n";
+    }
 }
 
 // === Точка входа ===
 
 int main(int argc, char* argv[]) {
-    // Если есть аргументы командной строки, обрабатываем их
+    // cout не синхронизируется с stdio (программа пишет только через
+    // iostream) и буферизуется; cin по-прежнему сбрасывает cout перед вводом
+    ios::sync_with_stdio(false);
+    
+    // В файл или канал превью записей не выводятся: их никто не читает,
+    // а на больших файлах вывод стоит дороже самого шифрования
+    quietMode = !isTerminal(stdout);
+    
+    // Если есть аргументы командной строки, обрабатываем их;
+    // код возврата сообщает конвейеру об ошибке
+    int exitCode = 0;
     if (argc > 1) {
-        processCLI(argc, argv);
+        exitCode = processCLI(argc, argv) ? 0 : 1;
+        reportStats();
     } else {
         // Иначе запускаем интерактивное меню
         interactiveMenu();
     }
     
-    return 0;
+    if (stdoutBuffer) {
+        cout.rdbuf(stdoutBuffer);
+    }
+    return exitCode;
 }
@@ -0,0 +1,264 @@
+#include "stats.h"
+#include "json_parser.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// Флаг читается в каждом operator new; меняется один раз до запуска потоков
+std::atomic<bool> countingEnabled{false};
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedByteCount{0};
+
+std::vector<StageStats> stages;
+
+// Итог считается только по внешним этапам: вложенный этап уже входит во
+// время, аллокации и RSS объемлющего, и сумма по всем этапам учла бы его
+// дважды
+StageStats outerStats;
+size_t openTimers = 0;
+
+/**
+ * @brief Пиковый RSS процесса, КБ (0, если недоступен)
+ */
+long peakRssKb() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;  // На macOS — в байтах
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+void* allocate(std::size_t size, bool nothrow) {
+    if (countingEnabled.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedByteCount.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (size == 0) size = 1;
+    while (true) {
+        if (void* memory = std::malloc(size)) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow) return nullptr;
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // namespace
+
+// === Подсчёт аллокаций ===
+// Замена глобальных operator new/delete; выровненные варианты остаются
+// стандартными и не учитываются
+
+void* operator new(std::size_t size) {
+    return allocate(size, false);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size, false);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size, true);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size, true);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+// === Этапы ===
+
+void enableStats() {
+    countingEnabled.store(true, std::memory_order_relaxed);
+}
+
+bool statsEnabled() {
+    return countingEnabled.load(std::memory_order_relaxed);
+}
+
+StageTimer::StageTimer(const char* stage) {
+    if (!statsEnabled()) return;
+
+    // Этапов единицы — линейный поиск по имени
+    for (index = 0; index < stages.size(); index++) {
+        if (stages[index].name == stage) break;
+    }
+    if (index == stages.size()) {
+        stages.push_back(StageStats());
+        stages.back().name = stage;
+    }
+
+    outer = openTimers++ == 0;
+    startAllocations = allocationCount.load(std::memory_order_relaxed);
+    startAllocatedBytes = allocatedByteCount.load(std::memory_order_relaxed);
+    startPeakRssKb = peakRssKb();
+    start = std::chrono::steady_clock::now();
+}
+
+StageTimer::~StageTimer() {
+    if (index == SIZE_MAX) return;
+
+    auto finish = std::chrono::steady_clock::now();
+    long peak = peakRssKb();
+    int64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count();
+    uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - startAllocations;
+    uint64_t allocatedBytes = allocatedByteCount.load(std::memory_order_relaxed) - startAllocatedBytes;
+    
+    StageStats& stage = stages[index];
+    stage.calls++;
+    stage.wallNs += wallNs;
+    stage.bytes += bytes;
+    stage.records += records;
+    stage.allocations += allocations;
+    stage.allocatedBytes += allocatedBytes;
+    stage.peakRssKb = std::max(stage.peakRssKb, peak);
+    stage.peakRssGrowthKb += peak - startPeakRssKb;
+    
+    openTimers--;
+    if (outer) {
+        outerStats.calls++;
+        outerStats.wallNs += wallNs;
+        outerStats.allocations += allocations;
+        outerStats.allocatedBytes += allocatedBytes;
+        outerStats.peakRssGrowthKb += peak - startPeakRssKb;
+    }
+}
+
+const std::vector<StageStats>& getStageStats() {
+    return stages;
+}
+
+namespace {
+
+/**
+ * @brief Дополняет UTF-8 строку пробелами слева до width символов
+ */
+std::string padLeft(const std::string& text, size_t width) {
+    size_t characters = std::count_if(text.begin(), text.end(), [](char c) {
+        return (static_cast<unsigned char>(c) & 0xC0) != 0x80;
+    });
+    return std::string(width > characters ? width - characters : 0, ' ') + text;
+}
+
+StageStats totalStats() {
+    StageStats total = outerStats;
+    total.name = "total";
+    total.peakRssKb = peakRssKb();
+    return total;
+}
+
+} // namespace
+
+void printStats() {
+    // Таблица собирается целиком и выводится одной записью в stderr
+    std::ostringstream out;
+    out << "\nСтатистика по этапам:\n";
+    out << "этап            " << padLeft("вызовов", 8) << padLeft("время, мс", 12)
+        << padLeft("байт", 14) << padLeft("записей", 10) << padLeft("аллокаций", 12)
+        << padLeft("выделено, Б", 14) << padLeft("пик RSS, КБ", 14) << padLeft("+RSS", 10) << "\n";
+    out << std::string(110, '-') << "\n";
+
+    auto printRow = [&out](const StageStats& stage) {
+        out << std::left << std::setw(16) << stage.name << std::right
+            << std::setw(8) << stage.calls
+            << std::setw(12) << std::fixed << std::setprecision(2) << stage.wallNs / 1e6
+            << std::setw(14) << stage.bytes << std::setw(10) << stage.records
+            << std::setw(12) << stage.allocations << std::setw(14) << stage.allocatedBytes
+            << std::setw(14) << stage.peakRssKb << std::setw(10) << stage.peakRssGrowthKb << "\n";
+    };
+    for (const auto& stage : stages) {
+        printRow(stage);
+    }
+    out << std::string(110, '-') << "\n";
+    printRow(totalStats());
+    std::cerr << out.str();
+}
+
+void saveStatsJson(const std::string& filename) {
+    // Числа пишутся целыми: сериализатор JsonValue оставляет шесть
+    // значащих цифр
+    auto appendStage = [](std::string& json, const StageStats& stage) {
+        json += "{\"name\": ";
+        appendJsonString(json, stage.name);
+        json += ", \"calls\": " + std::to_string(stage.calls);
+        json += ", \"wall_ns\": " + std::to_string(stage.wallNs);
+        json += ", \"bytes\": " + std::to_string(stage.bytes);
+        json += ", \"records\": " + std::to_string(stage.records);
+        json += ", \"allocations\": " + std::to_string(stage.allocations);
+        json += ", \"allocated_bytes\": " + std::to_string(stage.allocatedBytes);
+        json += ", \"peak_rss_kb\": " + std::to_string(stage.peakRssKb);
+        json += ", \"peak_rss_growth_kb\": " + std::to_string(stage.peakRssGrowthKb) + "}";
+    };
+
+    std::string json = "{\n  \"stages\": [";
+    for (size_t i = 0; i < stages.size(); i++) {
+        json += i == 0 ? "\n    " : ",\n    ";
+        appendStage(json, stages[i]);
+    }
+    json += stages.empty() ? "],\n  \"total\": " : "\n  ],\n  \"total\": ";
+    appendStage(json, totalStats());
+    json += "\n}\n";
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Не удалось создать файл: " + filename);
+    }
+    out << json;
+    if (!out) {
+        throw std::runtime_error("Ошибка записи в файл: " + filename);
+    }
+}
@@ -0,0 +1,36 @@
+# Проверка лога после подбора ключа (--mode crack)
+#
+# В логе должен стоять подобранный ключ каждой записи, а не 0 из
+# командной строки — в обычном и в потоковом режиме.
+#
+# Запуск: cmake -DCIPHER=<путь к caesar_cipher> -DWORK_DIR=<каталог> -P crack_log_key.cmake
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/data")
+
+# Текст зашифрован ключом 7
+file(WRITE "${WORK_DIR}/encrypted.json" "[
+  {\"id\": 1, \"content\": \"aol xbpjr iyvdu mve qbtwz vcly aol shgf kvn dopsl aol zbu zlaz zsvdsf ilopuk aol kpzahua opssz huk aol lclupun hpy nyvdz jvsk\"}
+]
+")
+
+foreach(MODE_ARGS "" "--stream")
+    file(REMOVE "${WORK_DIR}/data/operations.log")
+    execute_process(
+        COMMAND "${CIPHER}" --mode crack --lang E --quiet
+                --input encrypted.json --output cracked.json ${MODE_ARGS}
+        WORKING_DIRECTORY "${WORK_DIR}"
+        RESULT_VARIABLE result
+        OUTPUT_QUIET
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "crack ${MODE_ARGS}: код возврата ${result}")
+    endif()
+
+    file(READ "${WORK_DIR}/data/operations.log" log)
+    string(FIND "${log}" "\"key\": 7" found)
+    if(found EQUAL -1)
+        message(FATAL_ERROR "crack ${MODE_ARGS}: в логе нет подобранного ключа 7:\n${log}")
+    endif()
+    message(STATUS "✓ crack ${MODE_ARGS}: в логе подобранный ключ")
+endforeach()
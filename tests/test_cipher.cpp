@@ -1,7 +1,20 @@
 #include "cipher.h"
+#include "logger.h"
+#include "log_segment.h"
+#include "log_rotation.h"
+#include "stats.h"
 #include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <cstdio>
 #include <cassert>
+#include <functional>
+#include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
@@ -45,7 +58,7 @@ int main() {
     assert_equal(encryptCaesar("Hello", 5, 'E'), "Mjqqt", "encryptCaesar('Hello', 5, 'E')");
     assert_equal(encryptCaesar("ABC", 1, 'E'), "BCD", "encryptCaesar('ABC', 1, 'E')");
     assert_equal(encryptCaesar("XYZ", 3, 'E'), "ABC", "encryptCaesar('XYZ', 3, 'E')");
-    assert_equal(encryptCaesar("Hello, World!", 7, 'E'), "Olmmp, Dsvmk!", "encryptCaesar с пунктуацией");
+    assert_equal(encryptCaesar("Hello, World!", 7, 'E'), "Olssv, Dvysk!", "encryptCaesar с пунктуацией");
     assert_equal(encryptCaesar("", 5, 'E'), "", "encryptCaesar пустой строки");
     assert_equal(encryptCaesar("123!@#", 5, 'E'), "123!@#", "encryptCaesar только спецсимволы");
     
@@ -77,14 +90,29 @@ int main() {
     cout << "─────────────────────────────────────────────────────────────\n";
     
     assert_equal(encryptCaesar("абв", 1, 'R'), "бвг", "encryptCaesar русского");
-    assert_equal(encryptCaesar("Привет", 1, 'R'), "Сулвhg", "encryptCaesar 'Привет' с ключом 1");
-    assert_equal(encryptCaesar("ЯЮЭ", 1, 'R'), "АБВ", "Циклический сдвиг русского");
+    assert_equal(encryptCaesar("Привет", 1, 'R'), "Рсйгёу", "encryptCaesar 'Привет' с ключом 1");
+    assert_equal(encryptCaesar("ЯЮЭ", 1, 'R'), "АЯЮ", "Циклический сдвиг русского");
+    assert_equal(encryptCaesar("еёж", 1, 'R'), "ёжз", "Буква ё входит в алфавит");
+    assert_equal(encryptCaesar("я", 32, 'R'), "ю", "encryptCaesar с ключом 32");
+    assert_equal(encryptCaesar("Mixed: Hello привет 123!", 3, 'R'), "Mixed: Hello тулезх 123!",
+                 "Латиница и цифры не меняются в русском режиме");
+    assert_equal(encryptCaesar("Ѐ№ѣ — Ђ", 5, 'R'), "Ѐ№ѣ — Ђ", "Прочие символы кириллицы не меняются");
     
     cout << "\n6. ДЕШИФРОВАНИЕ РУССКОГО ТЕКСТА\n";
     cout << "─────────────────────────────────────────────────────────────\n";
     
     assert_equal(decryptCaesar("бвг", 1, 'R'), "абв", "decryptCaesar русского");
-    assert_equal(decryptCaesar("Сулвhg", 1, 'R'), "Привет", "decryptCaesar 'Сулвhg'");
+    assert_equal(decryptCaesar("Рсйгёу", 1, 'R'), "Привет", "decryptCaesar 'Рсйгёу'");
+    
+    string russianText = "Съешь же ещё этих мягких французских булок, да выпей чаю. ЁЖИК";
+    bool roundTrip = true;
+    for (int key = 1; key <= 32; key++) {
+        if (decryptCaesar(encryptCaesar(russianText, key, 'R'), key, 'R') != russianText) {
+            roundTrip = false;
+        }
+    }
+    cout << (roundTrip ? "✓" : "✗") << " Шифрование и дешифрование для всех ключей 1-32" << endl;
+    testsRun++; if (roundTrip) testsPassed++;
     
     // === Тесты валидации ключа ===
     cout << "\n7. ВАЛИДАЦИЯ КЛЮЧА\n";
@@ -119,6 +147,513 @@ int main() {
     assert_throws([](){ encryptCaesar("text", 26, 'E'); }, "encryptCaesar с ключом 26");
     assert_throws([](){ encryptCaesar("text", 33, 'R'); }, "encryptCaesar с ключом 33");
     
+    // === Шифрование без выделения памяти ===
+    cout << "\n9. ШИФРОВАНИЕ НА МЕСТЕ И В БУФЕР\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    string inPlace = "Hello, World!";
+    encryptCaesarInPlace(inPlace, 7, 'E');
+    assert_equal(inPlace, "Olssv, Dvysk!", "encryptCaesarInPlace английского");
+    decryptCaesarInPlace(inPlace, 7, 'E');
+    assert_equal(inPlace, "Hello, World!", "decryptCaesarInPlace английского");
+    
+    string russianInPlace = "Привет, мир!";
+    encryptCaesarInPlace(russianInPlace, 7, 'R');
+    assert_equal(russianInPlace, "Цчпилщ, упч!", "encryptCaesarInPlace русского");
+    
+    char buffer[64];
+    size_t written = encryptCaesar(string_view("Привет"), buffer, 1, 'R');
+    assert_equal(string(buffer, written), "Рсйгёу", "encryptCaesar в буфер");
+    written = decryptCaesar(string_view("Ifmmp"), buffer, 1, 'E');
+    assert_equal(string(buffer, written), "Hello", "decryptCaesar в буфер");
+    
+    assert_throws([](){ string text = "text"; encryptCaesarInPlace(text, 0, 'E'); },
+                  "encryptCaesarInPlace с ключом 0");
+    assert_throws([](){ char out[4]; encryptCaesar(string_view("text"), out, 33, 'R'); },
+                  "encryptCaesar в буфер с ключом 33");
+    
+    // === Векторные ядра ===
+    cout << "\n10. ВЕКТОРНЫЕ ЯДРА (ФАЗЗИНГ)\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    cout << "  Активное ядро: " << getCipherKernelName(getCipherKernel()) << endl;
+    
+    // Случайные строки из всех 256 байтов и строки из одних букв
+    // сравниваются с результатом скалярного ядра для всех ключей
+    mt19937 rng(20251221);
+    vector<string> samples;
+    for (int i = 0; i < 300; i++) {
+        string sample(rng() % 200, '\0');
+        for (char& ch : sample) {
+            ch = (i % 2 == 0) ? static_cast<char>(rng() % 256)
+                              : "azAZmMnN @[`{"[rng() % 13];
+        }
+        samples.push_back(sample);
+    }
+    
+    CipherKernel defaultKernel = getCipherKernel();
+    for (CipherKernel kernel : {CipherKernel::SSE2, CipherKernel::AVX2}) {
+        string testName = "Ядро " + getCipherKernelName(kernel) + " совпадает со скалярным";
+        if (!isCipherKernelSupported(kernel)) {
+            cout << "- " << testName << " (не поддерживается процессором)" << endl;
+            continue;
+        }
+        
+        size_t mismatches = 0;
+        for (const string& sample : samples) {
+            for (int key = 1; key <= 25; key++) {
+                setCipherKernel(CipherKernel::Scalar);
+                string expectedEnc = encryptCaesar(sample, key, 'E');
+                string expectedDec = decryptCaesar(sample, key, 'E');
+                setCipherKernel(kernel);
+                if (encryptCaesar(sample, key, 'E') != expectedEnc) mismatches++;
+                if (decryptCaesar(sample, key, 'E') != expectedDec) mismatches++;
+            }
+        }
+        
+        testsRun++;
+        if (mismatches == 0) {
+            cout << "✓ " << testName << endl;
+            testsPassed++;
+        } else {
+            cout << "✗ " << testName << " (расхождений: " << mismatches << ")" << endl;
+        }
+    }
+    setCipherKernel(defaultKernel);
+    
+    // === Журнал операций ===
+    cout << "\n11. ЖУРНАЛ ОПЕРАЦИЙ (NDJSON)\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    const string logName = "test_cipher_operations.log";
+    {
+        ofstream legacy(logName);
+        legacy << "[\n  {\"timestamp\": \"2025-12-21T22:05:30\", \"operation\": \"encrypt\", \"key\": 7,"
+                  " \"id\": 1, \"status\": \"успешно\", \"message\": \"\"}\n]";
+    }
+    {
+        Logger logger(logName);
+        assert_equal(to_string(logger.size()), "0", "История при запуске не читается");
+        logger.log("decrypt", 3, 2, "ошибка", "строка с \"кавычками\"\nи переводом");
+        logger.saveToFile();
+    }
+    {
+        // Недописанная строка после аварийного завершения
+        ofstream broken(logName, ios::app);
+        broken << "{\"id\": 3, \"key\"";
+    }
+    
+    vector<string> lines;
+    {
+        ifstream logIn(logName);
+        for (string line; getline(logIn, line);) lines.push_back(line);
+    }
+    assert_equal(to_string(lines.size()), "3", "Старый массив переведён в NDJSON, запись дописана строкой");
+    
+    vector<LogEntry> history = readLogFile(logName);
+    string historySummary;
+    for (const auto& entry : history) {
+        historySummary += to_string(entry.id) + ":" + entry.operation + ":" + to_string(entry.key) + ";";
+    }
+    assert_equal(historySummary, "1:encrypt:7;2:decrypt:3;", "Чтение NDJSON, повреждённая строка пропущена");
+    assert_equal(history.size() == 2 ? history[1].message : "", "строка с \"кавычками\"\nи переводом",
+                 "Сообщение с экранированием сохраняется");
+    
+    // Время хранится в наносекундах; кэш секунды обновляется при её смене
+    int64_t legacyNs = history.empty() ? 0 : history[0].timestampNs;
+    assert_equal(history.empty() ? "" : history[0].timestamp(), "2025-12-21T22:05:30",
+                 "Временная метка старого лога восстанавливается");
+    assert_equal(formatTimestamp(legacyNs + 999999999) + " " + formatTimestamp(legacyNs + 1000000000),
+                 "2025-12-21T22:05:30 2025-12-21T22:05:31", "Кэш секунды сменяется на границе секунды");
+    remove(logName.c_str());
+    
+    // === Асинхронный логгер ===
+    cout << "\n12. АСИНХРОННЫЙ ЛОГГЕР\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    const string asyncLogName = "test_cipher_async.log";
+    remove(asyncLogName.c_str());
+    {
+        Logger asyncLogger(asyncLogName);
+        AsyncLogOptions options;
+        options.batchEntries = 64;
+        asyncLogger.startAsync(options);
+        
+        vector<thread> producers;
+        for (int worker = 0; worker < 4; worker++) {
+            producers.emplace_back([&asyncLogger, worker]() {
+                for (int i = 0; i < 1000; i++) {
+                    asyncLogger.log("encrypt", 5, worker * 1000 + i, "успешно");
+                }
+            });
+        }
+        for (auto& producer : producers) producer.join();
+        
+        asyncLogger.saveToFile();
+        assert_equal(to_string(readLogFile(asyncLogName).size()), "4000",
+                     "saveToFile() дожидается записи всей очереди");
+        
+        // Последние записи дописываются при остановке в деструкторе
+        asyncLogger.log("decrypt", 5, 4000, "успешно");
+    }
+    
+    vector<LogEntry> asyncHistory = readLogFile(asyncLogName);
+    vector<bool> seen(4001, false);
+    size_t uniqueIds = 0;
+    for (const auto& entry : asyncHistory) {
+        if (entry.id >= 0 && entry.id <= 4000 && !seen[entry.id]) {
+            seen[entry.id] = true;
+            uniqueIds++;
+        }
+    }
+    assert_equal(to_string(uniqueIds) + "/" + to_string(asyncHistory.size()), "4001/4001",
+                 "Очередь дописана при остановке, записи не потеряны и не повторены");
+    remove(asyncLogName.c_str());
+    
+    // === Бинарные сегменты лога ===
+    cout << "\n13. БИНАРНЫЕ СЕГМЕНТЫ ЛОГА\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    const string segmentName = "test_cipher_log.seg";
+    const int64_t baseNs = 1766300000LL * 1000000000LL;
+    vector<LogEntry> segmentEntries;
+    mt19937 segmentRng(7);
+    for (int i = 0; i < 5000; i++) {
+        LogEntry entry;
+        // Время слегка перемешано, как у записей из нескольких потоков
+        entry.timestampNs = baseNs + (i + static_cast<int>(segmentRng() % 5)) * 1000000000LL;
+        entry.id = static_cast<int>(segmentRng() % 300);
+        entry.key = 1 + static_cast<int>(segmentRng() % 25);
+        entry.operation = (segmentRng() % 2) ? "encrypt" : "decrypt";
+        entry.status = (segmentRng() % 10) ? "успешно" : "ошибка";
+        entry.message = entry.status == "ошибка" ? "Ошибка: ключ " + to_string(entry.key) : "";
+        segmentEntries.push_back(entry);
+    }
+    LogSegment::write(segmentName, segmentEntries, 64);
+    
+    LogSegment segment(segmentName);
+    assert_equal(to_string(segment.size()), "5000", "Сегмент содержит все записи");
+    
+    // Сравнение с полным перебором на случайных запросах
+    size_t wrongQueries = 0;
+    for (int q = 0; q < 200; q++) {
+        LogQuery query;
+        if (q % 3 != 1) query.id = static_cast<int>(segmentRng() % 310);
+        if (q % 3 != 0) {
+            query.fromNs = baseNs + static_cast<int64_t>(segmentRng() % 5000) * 1000000000LL;
+            query.toNs = query.fromNs + static_cast<int64_t>(segmentRng() % 800) * 1000000000LL;
+        }
+        if (q % 4 == 0) query.operation = "decrypt";
+        
+        vector<string> expected;
+        for (const auto& entry : segmentEntries) {
+            if (query.id && entry.id != *query.id) continue;
+            if (entry.timestampNs < query.fromNs || entry.timestampNs >= query.toNs) continue;
+            if (query.operation && entry.operation != *query.operation) continue;
+            expected.push_back(to_string(entry.timestampNs) + "/" + to_string(entry.id) + "/" +
+                               to_string(entry.key) + "/" + entry.status + "/" + entry.message);
+        }
+        vector<string> actual;
+        int64_t previousNs = INT64_MIN;
+        bool ordered = true;
+        for (const auto& entry : segment.query(query)) {
+            ordered = ordered && entry.timestampNs >= previousNs;
+            previousNs = entry.timestampNs;
+            actual.push_back(to_string(entry.timestampNs) + "/" + to_string(entry.id) + "/" +
+                             to_string(entry.key) + "/" + entry.status + "/" + entry.message);
+        }
+        sort(expected.begin(), expected.end());
+        sort(actual.begin(), actual.end());
+        if (!ordered || expected != actual) wrongQueries++;
+    }
+    assert_equal(to_string(wrongQueries), "0", "Запросы по id, времени и операции совпадают с перебором");
+    
+    LogQuery unknownOperation;
+    unknownOperation.operation = "rotate";
+    assert_equal(to_string(segment.query(unknownOperation).size()), "0", "Неизвестная операция — пустой результат");
+    remove(segmentName.c_str());
+    
+    {
+        ofstream notSegment(segmentName);
+        notSegment << "{\"operation\":\"encrypt\",\"key\":3,\"id\":1}\n";
+    }
+    assert_throws([&]() { LogSegment broken(segmentName); }, "Файл не в формате сегмента отклоняется");
+    remove(segmentName.c_str());
+    
+    // === Ротация лога ===
+    cout << "\n14. РОТАЦИЯ ЛОГА\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    const string rotatedName = "test_cipher_rotated.log";
+    auto removeRotated = [&]() {
+        remove(rotatedName.c_str());
+        remove(logManifestFile(rotatedName).c_str());
+        for (int n = 1; n <= 20; n++) {
+            string sealed = rotatedName + "." + to_string(n);
+            remove(sealed.c_str());
+            remove((sealed + ".seg").c_str());
+        }
+    };
+    removeRotated();
+    {
+        Logger rotatedLogger(rotatedName);
+        LogRotationOptions rotation;
+        rotation.maxBytes = 4096;
+        rotation.maxEntriesInMemory = 100;
+        rotatedLogger.setRotation(rotation);
+        for (int i = 0; i < 300; i++) {
+            rotatedLogger.log(i % 2 ? "encrypt" : "decrypt", 7, i, "успешно");
+        }
+        rotatedLogger.saveToFile();
+        
+        vector<LogEntry> recent = rotatedLogger.getEntries();
+        assert_equal(to_string(recent.size()) + " " + to_string(recent.front().id) + " " + to_string(recent.back().id),
+                     "100 200 299", "В памяти только последние записи, от старых к новым");
+        
+        LogManifest manifest = loadLogManifest(rotatedName);
+        bool bounded = !manifest.segments.empty();
+        uint64_t sealedEntries = 0;
+        for (const auto& segment : manifest.segments) {
+            bounded = bounded && segment.bytes >= 4096 && segment.bytes < 4096 + 200;
+            sealedEntries += segment.entries;
+        }
+        assert_equal(bounded ? "да" : "нет", "да", "Сегменты закрываются по порогу размера");
+        assert_equal(to_string(sealedEntries + readLogFile(rotatedName).size()), "300",
+                     "Манифест и активный файл покрывают все записи");
+        
+        vector<LogEntry> history = readLogHistory(rotatedName);
+        bool ordered = history.size() == 300;
+        for (size_t i = 0; ordered && i < history.size(); i++) {
+            ordered = history[i].id == static_cast<int>(i);
+        }
+        assert_equal(ordered ? "да" : "нет", "да", "История читается по сегментам по порядку");
+        
+        rotatedLogger.loadFromFile();
+        assert_equal(to_string(rotatedLogger.size()), "100", "loadFromFile() читает только последние записи");
+    }
+    
+    // Перезапуск с непустым файлом: при старте читается только первая
+    // строка, записи прежнего запуска считаются при закрытии сегмента
+    removeRotated();
+    {
+        Logger previousRun(rotatedName);
+        for (int i = 0; i < 20; i++) {
+            previousRun.log("encrypt", 7, i, "успешно");
+        }
+        previousRun.saveToFile();
+    }
+    {
+        Logger restartedLogger(rotatedName);
+        LogRotationOptions rotation;
+        rotation.maxBytes = 4096;
+        restartedLogger.setRotation(rotation);
+        for (int i = 20; i < 100; i++) {
+            restartedLogger.log("decrypt", 7, i, "успешно");
+        }
+        restartedLogger.saveToFile();
+    }
+    LogManifest restartedManifest = loadLogManifest(rotatedName);
+    uint64_t restartedEntries = 0;
+    for (const auto& segment : restartedManifest.segments) {
+        restartedEntries += segment.entries;
+    }
+    vector<LogEntry> firstSealed = restartedManifest.segments.empty() ? vector<LogEntry>() :
+                                   readLogFile(sealedSegmentPath(rotatedName, restartedManifest.segments.front()));
+    bool firstCounted = !firstSealed.empty() &&
+                        restartedManifest.segments.front().entries == firstSealed.size() &&
+                        restartedManifest.segments.front().firstNs == firstSealed.front().timestampNs;
+    assert_equal(to_string(restartedEntries + readLogFile(rotatedName).size()) + " " + (firstCounted ? "да" : "нет"),
+                 "100 да", "Записи прежнего запуска учитываются в сегменте");
+    
+    // Сжатие и удаление старых сегментов
+    removeRotated();
+    {
+        Logger rotatedLogger(rotatedName);
+        LogRotationOptions rotation;
+        rotation.maxBytes = 2048;
+        rotation.compress = true;
+        rotation.maxSegments = 3;
+        rotatedLogger.setRotation(rotation);
+        for (int i = 0; i < 300; i++) {
+            rotatedLogger.log("encrypt", 7, i, i % 10 ? "успешно" : "ошибка", i % 10 ? "" : "Ошибка: запись " + to_string(i));
+        }
+        rotatedLogger.saveToFile();
+    }
+    LogManifest compressedManifest = loadLogManifest(rotatedName);
+    bool allCompressed = compressedManifest.segments.size() == 3;
+    for (const auto& segment : compressedManifest.segments) {
+        allCompressed = allCompressed && segment.compressed &&
+                        ifstream(sealedSegmentPath(rotatedName, segment)).good();
+    }
+    assert_equal(allCompressed ? "да" : "нет", "да", "Хранятся только 3 последних сжатых сегмента");
+    assert_equal(ifstream(rotatedName + ".1").good() || ifstream(rotatedName + ".1.seg").good() ? "есть" : "удалён",
+                 "удалён", "Старейший сегмент удалён с диска");
+    
+    vector<LogEntry> compressedHistory = readLogHistory(rotatedName);
+    bool contiguous = !compressedHistory.empty() && compressedHistory.back().id == 299;
+    for (size_t i = 1; contiguous && i < compressedHistory.size(); i++) {
+        contiguous = compressedHistory[i].id == compressedHistory[i - 1].id + 1;
+    }
+    assert_equal(contiguous ? "да" : "нет", "да", "Сжатые сегменты читаются без потерь");
+    assert_equal(compressedHistory.size() > 10 ? compressedHistory[compressedHistory.size() - 10].message : "",
+                 "Ошибка: запись 290", "Сообщения восстанавливаются из словаря");
+    
+    LogQuery rotatedQuery;
+    rotatedQuery.id = 295;
+    size_t rebuilt = 0, total = 0;
+    vector<LogEntry> rotatedFound = queryLogHistory(rotatedName, rotatedQuery, rebuilt, total);
+    assert_equal(to_string(rotatedFound.size()) + " " + to_string(total == compressedHistory.size()),
+                 "1 1", "Запрос идёт по всем сегментам");
+    remove((rotatedName + ".seg").c_str());
+    removeRotated();
+
+    // Ошибка сжатия не теряет сегмент: активный файл и манифест прежние
+    ofstream(rotatedName) << "[{\"id\": 1";
+    LogManifest failedManifest;
+    LogRotationOptions compressOnly;
+    compressOnly.compress = true;
+    assert_throws([&]() { sealLogFile(rotatedName, failedManifest, compressOnly); },
+                  "sealLogFile сообщает об ошибке сжатия");
+    assert_equal(to_string(failedManifest.next) + " " + to_string(failedManifest.segments.size()) + " " +
+                 (ifstream(rotatedName).good() ? "есть" : "нет") + " " +
+                 (ifstream(rotatedName + ".1.seg").good() ? "есть" : "нет"),
+                 "1 0 есть нет", "После ошибки сжатия лог и манифест не меняются");
+    removeRotated();
+    
+    // === Статистика по этапам ===
+    cout << "\n15. СТАТИСТИКА ПО ЭТАПАМ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    {
+        StageTimer disabled("disabled");
+        disabled.addBytes(1);
+    }
+    assert_equal(to_string(getStageStats().size()), "0", "Без enableStats() этапы не записываются");
+    
+    enableStats();
+    for (int call = 0; call < 3; call++) {
+        StageTimer stage("encrypt");
+        vector<string> results;
+        for (int i = 0; i < 10; i++) {
+            results.push_back(encryptCaesar(string(100, 'a'), 3, 'E'));
+        }
+        stage.addBytes(1000);
+        stage.addRecords(10);
+    }
+    {
+        StageTimer stage("save");
+    }
+    const vector<StageStats>& stageStats = getStageStats();
+    assert_equal(stageStats.size() == 2 ? stageStats[0].name + "," + stageStats[1].name : "",
+                 "encrypt,save", "Этапы в порядке первого появления");
+    assert_equal(to_string(stageStats[0].calls) + " " + to_string(stageStats[0].bytes) + " " +
+                 to_string(stageStats[0].records), "3 3000 30", "Повторные вызовы этапа суммируются");
+    assert_equal(stageStats[0].allocations >= 30 && stageStats[0].allocatedBytes >= 3000 ? "да" : "нет", "да",
+                 "Аллокации этапа подсчитываются");
+    
+    const string statsName = "test_cipher_stats.json";
+    saveStatsJson(statsName);
+    JsonValue statsReport = loadJsonFile(statsName);
+    assert_equal(to_string(static_cast<int>(statsReport.asObject().at("total").asObject().at("calls").asNumber())),
+                 "4", "Отчёт в JSON читается парсером");
+
+    {
+        StageTimer outer("outer");
+        StageTimer inner("inner");
+        vector<string> results(10, string(100, 'a'));
+    }
+    saveStatsJson(statsName);
+    JsonValue nestedReport = loadJsonFile(statsName);
+    const JsonObject& nestedTotal = nestedReport.asObject().at("total").asObject();
+    int64_t outerWallNs = 0;
+    for (const auto& stage : getStageStats()) {
+        if (stage.name != "inner") outerWallNs += stage.wallNs;
+    }
+    assert_equal(to_string(static_cast<int>(nestedTotal.at("calls").asNumber())) + " " +
+                 (static_cast<int64_t>(nestedTotal.at("wall_ns").asNumber()) == outerWallNs ? "да" : "нет"),
+                 "5 да", "Вложенный этап не входит в итог дважды");
+    remove(statsName.c_str());
+
+    // Узлы асинхронного лога берутся из пула: после прогрева log() не
+    // выделяет память. Писатель спит, пока идёт замер; каждый прогон — в
+    // новом потоке, чтобы узлы брались из общего пула, а не из кэша потока
+    const string pooledLogName = "test_cipher_pooled.log";
+    remove(pooledLogName.c_str());
+    {
+        Logger pooledLogger(pooledLogName);
+        AsyncLogOptions sleepy;
+        sleepy.batchEntries = 1000000;
+        sleepy.flushInterval = chrono::hours(1);
+        pooledLogger.startAsync(sleepy);
+        const string message = "Ошибка: длинное сообщение записи";
+        auto logBatch = [&pooledLogger, &message](bool measure) {
+            if (measure) {
+                StageTimer stage("async_log");
+                for (int i = 0; i < 1000; i++) {
+                    pooledLogger.log(i % 2 ? "crack" : "custom", 3, i, "ошибка", message);
+                }
+            } else {
+                for (int i = 0; i < 1000; i++) {
+                    pooledLogger.log("decrypt", 3, i, "успешно", message);
+                }
+            }
+        };
+        thread(logBatch, false).join();
+        pooledLogger.saveToFile();
+        thread(logBatch, true).join();
+        pooledLogger.saveToFile();
+        assert_equal(to_string(getStageStats().back().allocations), "0",
+                     "Асинхронный log() после прогрева не выделяет память");
+
+        vector<LogEntry> pooledHistory = pooledLogger.getEntries();
+        assert_equal(pooledHistory.size() == 2000 ? pooledHistory[0].operation + " " + pooledHistory[0].status + " " +
+                     pooledHistory[1000].operation + " " + pooledHistory[1000].status + " " + pooledHistory[1000].message : "",
+                     "decrypt успешно custom ошибка Ошибка: длинное сообщение записи",
+                     "Коды операции и статуса раскрываются писателем");
+    }
+    remove(pooledLogName.c_str());
+    
+    // === Подбор ключа ===
+    cout << "\n16. ПОДБОР КЛЮЧА ПО ЧАСТОТАМ БУКВ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    LetterHistogram histogram = buildLetterHistogram("AbC abc Ёё ЯЖ 123!");
+    assert_equal(to_string(histogram.english[0]) + " " + to_string(histogram.english[2]) + " " +
+                 to_string(histogram.englishLetters), "2 2 6", "Гистограмма латиницы без учёта регистра");
+    assert_equal(to_string(histogram.russian[6]) + " " + to_string(histogram.russian[32]) + " " +
+                 to_string(histogram.russianLetters), "2 1 4", "Гистограмма кириллицы, ё — седьмая буква");
+    
+    const string englishPlain = "It was the best of times, it was the worst of times, it was the age of "
+                                "wisdom, it was the age of foolishness, it was the epoch of belief.";
+    const string russianPlain = "Все счастливые семьи похожи друг на друга, каждая несчастливая "
+                                "семья несчастлива по-своему. Всё смешалось в доме Облонских.";
+    CaesarCrackResult englishCrack = crackCaesar(encryptCaesar(englishPlain, 17, 'E'));
+    assert_equal(string(1, englishCrack.lang) + " " + to_string(englishCrack.key), "E 17",
+                 "Ключ английского текста подобран");
+    assert_equal(englishCrack.text, englishPlain, "Английский текст расшифрован найденным ключом");
+    
+    CaesarCrackResult russianCrack = crackCaesar(encryptCaesar(russianPlain, 29, 'R'));
+    assert_equal(string(1, russianCrack.lang) + " " + to_string(russianCrack.key), "R 29",
+                 "Ключ русского текста подобран, язык определён по тексту");
+    assert_equal(russianCrack.text, russianPlain, "Русский текст расшифрован найденным ключом");
+    
+    CaesarCrackResult plainCrack = crackCaesar(englishPlain, 'E');
+    assert_equal(to_string(plainCrack.key) + " " + to_string(plainCrack.text == englishPlain),
+                 "0 1", "Несдвинутый текст — ключ 0");
+    
+    // Оценки ключей совпадают с расшифровкой каждым ключом
+    string russianCipher = encryptCaesar(russianPlain, 5, 'R');
+    vector<double> scores = scoreCaesarKeys(buildLetterHistogram(russianCipher), 'R');
+    bool scoresMatch = scores.size() == 33;
+    for (int key = 1; scoresMatch && key < 33; key++) {
+        double bruteForce = scoreCaesarKeys(buildLetterHistogram(decryptCaesar(russianCipher, key, 'R')), 'R')[0];
+        scoresMatch = abs(scores[key] - bruteForce) < 1e-6 * max(1.0, bruteForce);
+    }
+    assert_equal(scoresMatch ? "да" : "нет", "да", "Оценки по гистограмме равны оценкам расшифровок");
+    
+    assert_equal(to_string(findCaesarKey("123, !?").key), "0", "Текст без букв — ключ 0");
+    assert_throws([]() { findCaesarKey("text", 'X'); }, "Неподдерживаемый язык отклоняется");
+    
     // === Результаты ===
     cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
     cout << "║                        РЕЗУЛЬТАТЫ ТЕСТОВ                      ║\n";
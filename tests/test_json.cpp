@@ -1,6 +1,11 @@
 #include "json_parser.h"
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
 
 using namespace std;
 
@@ -93,15 +98,449 @@ int main() {
     cout << (json2.find("42") != string::npos ? "✓" : "✗") << " Сериализация числа" << endl;
     testsRun++; if (json2.find("42") != string::npos) testsPassed++;
     
-    JsonValue val3;
-    val3.type = JsonType::Array;
-    val3.arrayValue.push_back(JsonValue(1.0));
-    val3.arrayValue.push_back(JsonValue(2.0));
+    JsonValue val3{JsonArray()};
+    val3.asArray().push_back(JsonValue(1.0));
+    val3.asArray().push_back(JsonValue(2.0));
     string json3 = jsonToString(val3, false);
     cout << (json3.find("[") != string::npos && json3.find("]") != string::npos ? "✓" : "✗") 
          << " Сериализация массива" << endl;
     testsRun++; if (json3.find("[") != string::npos && json3.find("]") != string::npos) testsPassed++;
     
+    // === Потоковое чтение и запись ===
+    cout << "\n6. ПОТОКОВАЯ ОБРАБОТКА МАССИВА\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    string arrayJson = "[ {\"id\": 1, \"content\": \"a],[b\\\"}\"}, 2, [3, {\"x\": []}], \"s\" , null ]";
+    JsonValue whole = parseJson(arrayJson);
+    
+    istringstream streamIn(arrayJson);
+    JsonArrayReader reader(streamIn);
+    JsonValue item;
+    JsonValue streamed{JsonArray()};
+    while (reader.next(item)) {
+        streamed.asArray().push_back(item);
+    }
+    bool sameElements = jsonToString(streamed, false) == jsonToString(whole, false);
+    cout << (sameElements ? "✓" : "✗") << " JsonArrayReader читает те же элементы, что parseJson" << endl;
+    testsRun++; if (sameElements) testsPassed++;
+    
+    bool sameOutput = true;
+    for (bool pretty : {true, false}) {
+        ostringstream streamOut;
+        JsonArrayWriter writer(streamOut, pretty);
+        for (const auto& element : whole.asArray()) {
+            writer.write(element);
+        }
+        writer.finish();
+        if (streamOut.str() != jsonToString(whole, pretty)) sameOutput = false;
+    }
+    cout << (sameOutput ? "✓" : "✗") << " JsonArrayWriter совпадает с jsonToString" << endl;
+    testsRun++; if (sameOutput) testsPassed++;
+    
+    // Объект пишется напрямую, без обёртки в JsonValue
+    bool objectOutput = true;
+    for (bool pretty : {true, false}) {
+        ostringstream valueOut, objectOut;
+        JsonArrayWriter valueWriter(valueOut, pretty), objectWriter(objectOut, pretty);
+        for (const auto& element : whole.asArray()) {
+            if (element.type() != JsonType::Object) continue;
+            valueWriter.write(element);
+            objectWriter.write(element.asObject());
+        }
+        valueWriter.finish();
+        objectWriter.finish();
+        if (objectOut.str() != valueOut.str()) objectOutput = false;
+    }
+    cout << (objectOutput ? "✓" : "✗") << " JsonArrayWriter пишет JsonObject так же, как JsonValue" << endl;
+    testsRun++; if (objectOutput) testsPassed++;
+    
+    // Текст элементов без разбора и запись его как есть
+    istringstream textIn("[ {\"a\": [1, {\"id\": 5}], \"s\": \"id\", \"id\": -12},\n  7 ]");
+    JsonArrayReader textReader(textIn);
+    string_view elementView;
+    vector<string> texts;
+    while (textReader.nextText(elementView)) {
+        texts.push_back(string(elementView));
+    }
+    bool textOk = texts.size() == 2 && texts[0] == "{\"a\": [1, {\"id\": 5}], \"s\": \"id\", \"id\": -12}" &&
+                  texts[1] == "7";
+    cout << (textOk ? "✓" : "✗") << " nextText возвращает текст элементов без пробелов вокруг" << endl;
+    testsRun++; if (textOk) testsPassed++;
+    
+    ostringstream rawOut;
+    JsonArrayWriter rawWriter(rawOut);
+    rawWriter.write(parseJson("{\"b\": 1}"));
+    rawWriter.writeRaw("{\"z\": 2,  \"a\": 1}");
+    rawWriter.finish();
+    bool rawOk = rawOut.str() == "[{\n    \"b\": 1\n  },\n  {\"z\": 2,  \"a\": 1}\n]";
+    cout << (rawOk ? "✓" : "✗") << " writeRaw пишет элемент без изменений" << endl;
+    testsRun++; if (rawOk) testsPassed++;
+    
+    istringstream emptyIn("  [ ]  ");
+    JsonArrayReader emptyReader(emptyIn);
+    bool emptyOk = !emptyReader.next(item);
+    ostringstream emptyOut;
+    JsonArrayWriter emptyWriter(emptyOut);
+    emptyWriter.finish();
+    emptyOk = emptyOk && emptyOut.str() == "[]";
+    cout << (emptyOk ? "✓" : "✗") << " Пустой массив в потоковом режиме" << endl;
+    testsRun++; if (emptyOk) testsPassed++;
+    
+    for (const string& invalid : {string("{\"id\": 1}"), string("[1, 2"), string("[1, ]"), string("[1] x")}) {
+        testsRun++;
+        try {
+            istringstream invalidIn(invalid);
+            JsonArrayReader invalidReader(invalidIn);
+            while (invalidReader.next(item)) {}
+            cout << "✗ JsonArrayReader отвергает '" << invalid << "' (должна быть ошибка)" << endl;
+        } catch (const exception&) {
+            cout << "✓ JsonArrayReader отвергает '" << invalid << "'" << endl;
+            testsPassed++;
+        }
+    }
+    
+    // === Заимствованные строки ===
+    cout << "\n7. ЗАИМСТВОВАННЫЕ СТРОКИ И ОТОБРАЖЕНИЕ ФАЙЛА\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    string source = "{\"plain\": \"Привет\", \"escaped\": \"a\\nb\"}";
+    JsonValue borrowedRoot = parseJson(source, true);
+    const JsonValue& plain = borrowedRoot.asObject()["plain"];
+    const JsonValue& escaped = borrowedRoot.asObject()["escaped"];
+    bool borrowOk = plain.isBorrowed() && plain.asStringView().data() >= source.data() &&
+                    plain.asStringView().data() < source.data() + source.size() &&
+                    plain.asString() == "Привет";
+    cout << (borrowOk ? "✓" : "✗") << " Строка без экранирования указывает во входной буфер" << endl;
+    testsRun++; if (borrowOk) testsPassed++;
+    
+    bool escapedOk = !escaped.isBorrowed() && escaped.asString() == "a\nb";
+    cout << (escapedOk ? "✓" : "✗") << " Строка с экранированием копируется" << endl;
+    testsRun++; if (escapedOk) testsPassed++;
+    
+    bool serializedOk = jsonToString(borrowedRoot, false) == jsonToString(parseJson(source), false);
+    cout << (serializedOk ? "✓" : "✗") << " Заимствованные строки сериализуются как обычные" << endl;
+    testsRun++; if (serializedOk) testsPassed++;
+    
+    const string docFile = "test_json_document.json";
+    {
+        ofstream out(docFile);
+        out << "[{\"id\": 1, \"content\": \"Hello\"}]";
+    }
+    bool documentOk = false;
+    try {
+        JsonDocument document(docFile);
+        // Перезапись файла не должна портить уже отображённый документ
+        saveJsonFile(docFile, parseJson("[]"), false);
+        const JsonValue& content = document.root().asArray().at(0).asObject().at("content");
+        documentOk = content.isBorrowed() && content.asString() == "Hello" &&
+                     jsonToString(loadJsonFile(docFile), false) == "[]";
+    } catch (const exception& e) {
+        cout << "  ошибка: " << e.what() << endl;
+    }
+    remove(docFile.c_str());
+    cout << (documentOk ? "✓" : "✗") << " JsonDocument переживает перезапись своего файла" << endl;
+    testsRun++; if (documentOk) testsPassed++;
+    
+    bool streamDocumentOk = false;
+    try {
+        istringstream documentIn(source);
+        JsonDocument streamDocument(documentIn);
+        const JsonValue& streamPlain = streamDocument.root().asObject().at("plain");
+        streamDocumentOk = streamPlain.isBorrowed() && streamPlain.asString() == "Привет" &&
+                           streamDocument.size() == source.size();
+    } catch (const exception& e) {
+        cout << "  ошибка: " << e.what() << endl;
+    }
+    cout << (streamDocumentOk ? "✓" : "✗") << " JsonDocument читается из потока (stdin)" << endl;
+    testsRun++; if (streamDocumentOk) testsPassed++;
+    
+    // === Разбор в арену ===
+    cout << "\n8. РАЗБОР В АРЕНУ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    const string arenaSource = "[{\"id\": 1, \"content\": \"Привет\", \"tags\": [\"a\\tb\", true, null]},"
+                               " {\"id\": 2, \"content\": \"Hello\", \"nested\": {\"x\": 1.5}}]";
+    bool arenaSameOk = false;
+    bool arenaBorrowOk = false;
+    bool arenaCopyOk = false;
+    try {
+        JsonArenaDocument arenaDoc(arenaSource);
+        arenaSameOk = jsonToString(arenaDoc.root(), true) == jsonToString(parseJson(arenaSource), true);
+        const JsonValue& tag = arenaDoc.root().asArray().at(0).asObject().at("tags").asArray().at(0);
+        arenaBorrowOk = tag.isBorrowed() && tag.asString() == "a\tb";
+        
+        // Копия корня живёт в обычной куче и изменяема
+        JsonValue copy = arenaDoc.root();
+        copy.asArray().at(1).asObject()["content"] = JsonValue(string("World"));
+        arenaCopyOk = copy.asArray().at(1).asObject().at("content").asString() == "World" &&
+                      arenaDoc.root().asArray().at(1).asObject().at("content").asString() == "Hello";
+    } catch (const exception& e) {
+        cout << "  ошибка: " << e.what() << endl;
+    }
+    cout << (arenaSameOk ? "✓" : "✗") << " Дерево в арене совпадает с обычным разбором" << endl;
+    testsRun++; if (arenaSameOk) testsPassed++;
+    cout << (arenaBorrowOk ? "✓" : "✗") << " Строки с экранированием размещаются в арене" << endl;
+    testsRun++; if (arenaBorrowOk) testsPassed++;
+    cout << (arenaCopyOk ? "✓" : "✗") << " Копия корня изменяема и не затрагивает арену" << endl;
+    testsRun++; if (arenaCopyOk) testsPassed++;
+    
+    bool arenaInvalidOk = false;
+    try {
+        JsonArenaDocument broken("{\"id\": ");
+    } catch (const exception&) {
+        arenaInvalidOk = true;
+    }
+    cout << (arenaInvalidOk ? "✓" : "✗") << " Невалидный JSON в арене выбрасывает исключение" << endl;
+    testsRun++; if (arenaInvalidOk) testsPassed++;
+    
+    // === Плоский объект ===
+    cout << "\n9. ПЛОСКИЙ ОБЪЕКТ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    JsonObject flat;
+    flat["operation"] = JsonValue(string("encrypt"));
+    flat["id"] = JsonValue(7.0);
+    flat.insert_or_assign("content", JsonValue(string("old")));
+    bool replaced = !flat.insert_or_assign("content", JsonValue(string("new"))).second;
+    bool lookupOk = replaced && flat.size() == 3 && flat.at("content").asString() == "new" &&
+                    flat.count("id") == 1 && flat.find("missing") == flat.end();
+    cout << (lookupOk ? "✓" : "✗") << " Поиск и замена значения по ключу" << endl;
+    testsRun++; if (lookupOk) testsPassed++;
+    
+    bool orderOk = jsonToString(JsonValue(flat), false) ==
+                   "{\"content\": \"new\", \"id\": 7, \"operation\": \"encrypt\"}";
+    cout << (orderOk ? "✓" : "✗") << " Ключи сериализуются в отсортированном порядке" << endl;
+    testsRun++; if (orderOk) testsPassed++;
+    
+    bool missingThrows = false;
+    try {
+        flat.at("missing");
+    } catch (const out_of_range&) {
+        missingThrows = true;
+    }
+    bool eraseOk = missingThrows && flat.erase("id") == 1 && flat.erase("id") == 0 && flat.size() == 2;
+    cout << (eraseOk ? "✓" : "✗") << " at() без ключа выбрасывает исключение, erase() удаляет" << endl;
+    testsRun++; if (eraseOk) testsPassed++;
+    
+    // === Формат сериализации ===
+    cout << "\n10. ФОРМАТ СЕРИАЛИЗАЦИИ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+    
+    JsonValue formatted = parseJson("{\"b\": [1, 2.5, \"x\"], \"a\": {\"k\": null, \"t\": true}, \"e\": [], \"o\": {}}");
+    bool compactOk = jsonToString(formatted, false) ==
+                     "{\"a\": {\"k\": null, \"t\": true}, \"b\": [1, 2.5, \"x\"], \"e\": [], \"o\": {}}";
+    cout << (compactOk ? "✓" : "✗") << " Компактный вывод" << endl;
+    testsRun++; if (compactOk) testsPassed++;
+    
+    bool prettyOk = jsonToString(formatted, true) ==
+                    "{\n  \"a\": {\n    \"k\": null,\n    \"t\": true\n  },\n"
+                    "  \"b\": [1,\n    2.5,\n    \"x\"\n  ],\n  \"e\": [],\n  \"o\": {}\n}";
+    cout << (prettyOk ? "✓" : "✗") << " Форматированный вывод" << endl;
+    testsRun++; if (prettyOk) testsPassed++;
+    
+    // Спецсимволы в начале, середине и конце длинной строки
+    string longText = "\"start" + string(20, 'a') + "\\mid\tПривет\x01" + string(9, 'b') + "\r\nend\"";
+    string longExpected = "\"\\\"start" + string(20, 'a') + "\\\\mid\\tПривет\x01" + string(9, 'b') +
+                          "\\r\\nend\\\"\"";
+    bool escapeOk = jsonToString(JsonValue(longText)) == longExpected;
+    cout << (escapeOk ? "✓" : "✗") << " Экранирование длинных строк" << endl;
+    testsRun++; if (escapeOk) testsPassed++;
+    
+    JsonArray numbers;
+    for (double n : {0.0, -3.0, 0.1, 123456.0, 1234567.0, 3.14159265, 1e-7}) {
+        numbers.emplace_back(n);
+    }
+    bool numbersOk = jsonToString(JsonValue(std::move(numbers)), false) ==
+                     "[0, -3, 0.1, 123456, 1.23457e+06, 3.14159, 1e-07]";
+    cout << (numbersOk ? "✓" : "✗") << " Формат чисел" << endl;
+    testsRun++; if (numbersOk) testsPassed++;
+    
+    // === Разбор по требованию ===
+    cout << "\n11. РАЗБОР ПО ТРЕБОВАНИЮ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+
+    vector<string_view> elements;
+    bool splitOk = splitJsonArray(" [ {\"a\": \"]\\\"}\"}, [1, [2]] ,null ] ", elements) &&
+                   elements.size() == 3 && elements[0] == "{\"a\": \"]\\\"}\"}" &&
+                   elements[1] == "[1, [2]]" && elements[2] == "null";
+    vector<string_view> noElements;
+    splitOk = splitOk && splitJsonArray("[]", noElements) && noElements.empty() &&
+              !splitJsonArray("{\"a\": 1}", noElements);
+    cout << (splitOk ? "✓" : "✗") << " splitJsonArray делит массив, не разбирая элементы" << endl;
+    testsRun++; if (splitOk) testsPassed++;
+
+    JsonFieldCursor cursor("{ \"k\\\"ey\" : {\"x\": [1, \"}\"]}, \"n\": -1.5e3 }");
+    string_view fieldKey, fieldValue;
+    bool cursorOk = cursor.next(fieldKey, fieldValue) && fieldKey == "k\\\"ey" &&
+                    fieldValue == "{\"x\": [1, \"}\"]}" &&
+                    cursor.next(fieldKey, fieldValue) && fieldKey == "n" && fieldValue == "-1.5e3" &&
+                    !cursor.next(fieldKey, fieldValue);
+    cout << (cursorOk ? "✓" : "✗") << " JsonFieldCursor отдаёт сырые ключи и значения" << endl;
+    testsRun++; if (cursorOk) testsPassed++;
+
+    string lazyText = "{\"id\": 3, \"content\": \"Привет\", \"note\": \"a\\tb\", \"meta\": {\"big\": 12345678}}";
+    JsonLazyObject lazy(lazyText);
+    JsonValue lazyValue;
+    bool getOk = lazy.get("content", lazyValue) && lazyValue.isBorrowed() &&
+                 lazyValue.asStringView() == "Привет" &&
+                 lazyValue.asStringView().data() > lazyText.data() &&
+                 lazy.get("note", lazyValue) && lazyValue.asStringView() == "a\tb" &&
+                 lazy.get("id", lazyValue) && lazyValue.asNumber() == 3 &&
+                 !lazy.get("missing", lazyValue) && !lazy.get("big", lazyValue) &&
+                 !lazy.modified();
+    cout << (getOk ? "✓" : "✗") << " JsonLazyObject разбирает поле при обращении" << endl;
+    testsRun++; if (getOk) testsPassed++;
+
+    ostringstream lazyOut;
+    JsonArrayWriter lazyWriter(lazyOut);
+    lazyWriter.write(JsonLazyObject("{\"b\":1,  \"a\":2}"));
+    lazy.insert_or_assign("id", JsonValue(4.0));
+    lazy.insert_or_assign("extra", JsonValue(string("x\ny")));
+    lazyWriter.write(lazy);
+    lazyWriter.finish();
+    bool lazyWriteOk = lazy.get("id", lazyValue) && lazyValue.asNumber() == 4 &&
+                       lazyOut.str() == "[{\"b\":1,  \"a\":2},\n  {\n"
+                                        "    \"content\": \"Привет\",\n    \"extra\": \"x\\ny\",\n"
+                                        "    \"id\": 4,\n    \"meta\": {\"big\": 12345678},\n"
+                                        "    \"note\": \"a\\tb\"\n  }\n]";
+    cout << (lazyWriteOk ? "✓" : "✗") << " Неизменённые поля и объекты пишутся как есть" << endl;
+    testsRun++; if (lazyWriteOk) testsPassed++;
+
+    {
+        ofstream lazyFile(docFile, ios::binary);
+        lazyFile << "[{\"id\": 1}, 2]";
+    }
+    bool onDemandOk = false;
+    {
+        JsonDocument lazyDocument(docFile, JsonParseMode::OnDemand);
+        vector<string_view> docElements;
+        onDemandOk = lazyDocument.root().type() == JsonType::Null &&
+                     lazyDocument.text() == "[{\"id\": 1}, 2]" &&
+                     splitJsonArray(lazyDocument.text(), docElements) && docElements.size() == 2;
+    }
+    remove(docFile.c_str());
+    cout << (onDemandOk ? "✓" : "✗") << " JsonDocument в режиме OnDemand не строит дерево" << endl;
+    testsRun++; if (onDemandOk) testsPassed++;
+
+    JsonLazyObject duplicate("{\"id\": 1, \"content\": \"a\", \"id\": 2}");
+    ostringstream duplicateOut;
+    JsonArrayWriter duplicateWriter(duplicateOut, false);
+    duplicate.insert_or_assign("x", JsonValue(true));
+    duplicateWriter.write(duplicate);
+    duplicateWriter.finish();
+    JsonValue fullDuplicate = parseJson(duplicate.text());
+    bool duplicateOk = duplicate.get("id", lazyValue) &&
+                       lazyValue.asNumber() == fullDuplicate.asObject().at("id").asNumber() &&
+                       lazyValue.asNumber() == 2 &&
+                       duplicateOut.str() == "[{\"content\": \"a\", \"id\": 2, \"x\": true}]";
+    cout << (duplicateOk ? "✓" : "✗") << " Повторяющийся ключ: действует последний, как в parseJson" << endl;
+    testsRun++; if (duplicateOk) testsPassed++;
+
+    // Числа — по грамматике JSON, одинаково для парсера и проверки
+    vector<string_view> numberElements;
+    bool numbersGrammarOk = parseJson("-0.5E-2").asNumber() == -0.005 && parseJson("1e3").asNumber() == 1000 &&
+                            splitJsonArray("[0, -1.25, 2e+2]", numberElements) && numberElements.size() == 3;
+    cout << (numbersGrammarOk ? "✓" : "✗") << " Числа с экспонентой" << endl;
+    testsRun++; if (numbersGrammarOk) testsPassed++;
+    for (const string& invalid : {string("01"), string("1."), string("-"), string(".5"), string("1e"), string("tru")}) {
+        testParseInvalid(invalid, "parseJson отвергает '" + invalid + "'");
+    }
+
+    // Пропущенные без разбора значения тоже проверяются: их текст уходит в выход как есть
+    const string invalidRecords =
+        "[{\"id\":1,\"content\":\"abc\",\"meta\":tru,\"x\":12abc},{\"id\":2,\"content\":\"x\",\"m\":{\"a\":[1}]}]";
+    for (const string& invalid : {invalidRecords, string("[{\"m\": tru}]"), string("[{\"m\": nul}]"),
+                                  string("[{\"m\": falsey}]"), string("[{\"x\": 12abc}]"), string("[{\"x\": 01}]"),
+                                  string("[{\"x\": 1.}]"), string("[{\"x\": -}]"), string("[{\"m\": {\"a\": [1}]}]"),
+                                  string("[{\"m\": [1, {\"b\": 2]}}]"), string("[[1, 2}]"), string("[{\"a\": 1,}]"),
+                                  string("[{\"m\": [1, ]}]"), string("[{\"m\": {\"a\" 1}}]")}) {
+        testsRun++;
+        int rejected = 0;
+        try {
+            vector<string_view> parts;
+            splitJsonArray(invalid, parts);
+        } catch (const exception&) {
+            rejected++;
+        }
+        try {
+            istringstream invalidIn(invalid);
+            JsonArrayReader invalidReader(invalidIn);
+            while (invalidReader.nextText(elementView)) {}
+        } catch (const exception&) {
+            rejected++;
+        }
+        try {
+            parseJson(invalid);
+        } catch (const exception&) {
+            rejected++;
+        }
+        bool rejectedOk = rejected == 3;
+        cout << (rejectedOk ? "✓" : "✗") << " splitJsonArray, nextText и parseJson отвергают '" << invalid << "'" << endl;
+        if (rejectedOk) testsPassed++;
+    }
+
+    for (const string& invalid : {string("[1, 2"), string("[1,, 2]"), string("[\"a]"), string("[1] x"),
+                                  string("{\"a\" 1}"), string("{\"a\": 1 \"b\": 2}"), string("[1 2]"),
+                                  string("{\"a\": tru}"), string("{\"a\": [1}}")}) {
+        testsRun++;
+        try {
+            vector<string_view> parts;
+            if (invalid[0] == '[') {
+                splitJsonArray(invalid, parts);
+            } else {
+                JsonFieldCursor invalidCursor(invalid);
+                while (invalidCursor.next(fieldKey, fieldValue)) {}
+            }
+            cout << "✗ Структурное сканирование отвергает '" << invalid << "' (должна быть ошибка)" << endl;
+        } catch (const exception&) {
+            cout << "✓ Структурное сканирование отвергает '" << invalid << "'" << endl;
+            testsPassed++;
+        }
+    }
+
+    // === Блочный поиск ===
+    cout << "\n12. БЛОЧНЫЙ ПОИСК КАВЫЧЕК И ПРОБЕЛОВ\n";
+    cout << "─────────────────────────────────────────────────────────────\n";
+
+    // Экранирование на каждой позиции относительно границ блоков
+    bool offsetsOk = true;
+    for (size_t offset = 0; offset < 40 && offsetsOk; offset++) {
+        string text = string(offset, 'a') + "\"\\" + string(37 - offset % 37, 'b') + "Я";
+        string json;
+        appendJsonString(json, text);
+        JsonValue heapValue = parseJson(json);
+        JsonValue borrowedValue = parseJson(json, true);
+        JsonArenaDocument arenaDocument(json);
+        offsetsOk = heapValue.asStringView() == text && borrowedValue.asStringView() == text &&
+                    arenaDocument.root().asStringView() == text;
+    }
+    cout << (offsetsOk ? "✓" : "✗") << " Экранирование на любой позиции строки" << endl;
+    testsRun++; if (offsetsOk) testsPassed++;
+
+    string spaced = "[" + string(35, ' ') + "\"x\"," + string(17, '\n') + "\t\r 1" + string(50, ' ') + "]";
+    JsonValue spacedValue = parseJson(spaced);
+    vector<string_view> spacedElements;
+    bool spacesOk = spacedValue.asArray().size() == 2 && spacedValue.asArray()[1].asNumber() == 1 &&
+                    splitJsonArray(spaced, spacedElements) && spacedElements.size() == 2 &&
+                    spacedElements[1] == "1";
+    cout << (spacesOk ? "✓" : "✗") << " Длинные пробельные участки" << endl;
+    testsRun++; if (spacesOk) testsPassed++;
+
+    testParseInvalid("\"" + string(100, 'a'), "Незакрытая длинная строка");
+    testParseInvalid("\"" + string(20, 'a') + "\\", "Длинная строка с оборванным экранированием");
+
+    // Строка длиннее блока потокового чтения (64 КБ) с экранированием на границе
+    string hugeText = string(65535, 'c') + "\"" + string(70000, 'd') + "\\";
+    string hugeJson = "[{\"content\": ";
+    appendJsonString(hugeJson, hugeText);
+    hugeJson += "}, 2]";
+    istringstream hugeIn(hugeJson);
+    JsonArrayReader hugeReader(hugeIn);
+    bool hugeOk = hugeReader.next(item) && item.asObject().at("content").asStringView() == hugeText &&
+                  hugeReader.next(item) && item.asNumber() == 2 && !hugeReader.next(item);
+    cout << (hugeOk ? "✓" : "✗") << " Потоковое чтение строки через границу блоков" << endl;
+    testsRun++; if (hugeOk) testsPassed++;
+
     // === Результаты ===
     cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
     cout << "║                        РЕЗУЛЬТАТЫ ТЕСТОВ                      ║\n";